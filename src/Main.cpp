@@ -8,6 +8,16 @@
 #include "mutexes/Mutexes.h"
 #include "condition/Condition.h"
 #include "pool/Pool.h"
+#include "pool/Watchdog.h"
+#include "pipeline/Pipeline.h"
+#include "simd/Kernels.h"
+#include "hashmap/ConcurrentHashMap.h"
+#include "executor/Executors.h"
+#include "tuning/Tuning.h"
+#include "ipc/SharedRing.h"
+#include "combining/FlatCombining.h"
+#include "percore/ShardedExecutor.h"
+#include "filescan/FileScan.h"
 
 int main()
 {
@@ -15,6 +25,13 @@ int main()
     std::cout << "Hardware concurrency: " << std::thread::hardware_concurrency() << " threads" << std::endl <<
         std::endl;
 
+    // Size the pools for this machine instead of guessing; the probe only runs
+    // until a profile has been saved
+    TuningProfile tuning = auto_tune(TuningOptions::from_environment());
+    std::cout << tuning << std::endl << std::endl;
+    const size_t threads = tuning.threads;
+    const PoolOptions options = tuning.pool_options();
+
     basic();
     std::cout << std::endl;
 
@@ -66,13 +83,43 @@ int main()
 
     std::cout << "C++ Thread Pool - Practical Example" << std::endl << std::endl;
 
-    basic_usage();
+    basic_usage(threads, options);
+    std::cout << std::endl;
+
+    dynamic_tasks(threads, options);
+    std::cout << std::endl;
+
+    shared_state(threads, options);
+    std::cout << std::endl;
+
+    overload();
+    std::cout << std::endl;
+
+    pipeline(threads, options);
+    std::cout << std::endl;
+
+    simd_kernels(threads, options);
+    std::cout << std::endl;
+
+    concurrent_map();
+    std::cout << std::endl;
+
+    blocking_offload(threads, options);
+    std::cout << std::endl;
+
+    watchdog();
+    std::cout << std::endl;
+
+    shared_ring();
+    std::cout << std::endl;
+
+    flat_combining();
     std::cout << std::endl;
 
-    dynamic_tasks();
+    thread_per_core();
     std::cout << std::endl;
 
-    shared_state();
+    file_scan(threads, options);
     std::cout << std::endl;
 
     return 0;
@@ -0,0 +1,228 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <utility>
+
+BenchRunner::BenchRunner(BenchConfig config) : config_(std::move(config))
+{
+}
+
+void BenchRunner::add(std::string name, std::string unit, std::function<Measurement(size_t threads)> run)
+{
+    cases_.push_back(BenchCase{std::move(name), std::move(unit), std::move(run)});
+}
+
+const BenchConfig& BenchRunner::config() const
+{
+    return config_;
+}
+
+size_t BenchRunner::scaled(size_t n) const
+{
+    return config_.quick ? std::max<size_t>(1, n / 20) : n;
+}
+
+double percentile(std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    double rank = p * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(rank);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+}
+
+BenchResult BenchRunner::summarise(const BenchCase& bench, size_t threads, std::vector<Measurement>& reps) const
+{
+    BenchResult result;
+    result.name = bench.name;
+    result.unit = bench.unit;
+    result.threads = threads;
+    result.repetitions = reps.size();
+    if (reps.empty())
+    {
+        return result;
+    }
+
+    std::vector<double> rates;
+    std::vector<double> latencies;
+    for (auto& rep : reps)
+    {
+        rates.push_back(rep.seconds > 0 ? rep.ops / rep.seconds : 0);
+        latencies.insert(latencies.end(), rep.latencies_ns.begin(), rep.latencies_ns.end());
+    }
+    std::sort(rates.begin(), rates.end());
+    std::sort(latencies.begin(), latencies.end());
+
+    double mean = std::accumulate(rates.begin(), rates.end(), 0.0) / rates.size();
+    double variance = 0;
+    for (double r : rates)
+    {
+        variance += (r - mean) * (r - mean);
+    }
+
+    result.median = percentile(rates, 0.5);
+    result.min = rates.front();
+    result.max = rates.back();
+    result.stddev = std::sqrt(variance / rates.size());
+    result.p50 = percentile(latencies, 0.5);
+    result.p90 = percentile(latencies, 0.9);
+    result.p99 = percentile(latencies, 0.99);
+    result.p999 = percentile(latencies, 0.999);
+    return result;
+}
+
+int BenchRunner::run()
+{
+    std::vector<BenchResult> results;
+
+    std::cout << std::left << std::setw(28) << "benchmark"
+        << std::right << std::setw(8) << "threads"
+        << std::setw(16) << "median ops/s"
+        << std::setw(10) << "+/- %"
+        << std::setw(12) << "p50 ns"
+        << std::setw(12) << "p99 ns"
+        << std::setw(12) << "p99.9 ns" << std::endl;
+
+    for (const auto& bench : cases_)
+    {
+        if (!config_.filter.empty() && bench.name.find(config_.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        for (size_t threads : config_.threads)
+        {
+            for (int i = 0; i < config_.warmup; ++i)
+            {
+                bench.run(threads);
+            }
+
+            std::vector<Measurement> reps;
+            for (int i = 0; i < config_.repetitions; ++i)
+            {
+                reps.push_back(bench.run(threads));
+            }
+
+            BenchResult result = summarise(bench, threads, reps);
+            results.push_back(result);
+
+            std::cout << std::left << std::setw(28) << result.name
+                << std::right << std::setw(8) << result.threads
+                // Coarse units such as GB scanned need the decimals
+                << std::fixed << std::setprecision(result.median < 100 ? 2 : 0)
+                << std::setw(16) << result.median
+                << std::setprecision(1)
+                << std::setw(10) << (result.median > 0 ? 100 * result.stddev / result.median : 0)
+                << std::setprecision(0)
+                << std::setw(12) << result.p50
+                << std::setw(12) << result.p99
+                << std::setw(12) << result.p999 << std::endl;
+        }
+    }
+
+    if (!config_.csv_path.empty())
+    {
+        write_csv(results);
+    }
+    if (!config_.json_path.empty())
+    {
+        write_json(results);
+    }
+    return config_.baseline_path.empty() ? 0 : compare_baseline(results);
+}
+
+void BenchRunner::write_csv(const std::vector<BenchResult>& results) const
+{
+    std::ofstream out(config_.csv_path);
+    out << "name,unit,threads,repetitions,median,min,max,stddev,p50_ns,p90_ns,p99_ns,p999_ns\n";
+    for (const auto& r : results)
+    {
+        out << r.name << ',' << r.unit << ',' << r.threads << ',' << r.repetitions << ','
+            << r.median << ',' << r.min << ',' << r.max << ',' << r.stddev << ','
+            << r.p50 << ',' << r.p90 << ',' << r.p99 << ',' << r.p999 << '\n';
+    }
+    std::cout << "Wrote " << results.size() << " results to " << config_.csv_path << std::endl;
+}
+
+void BenchRunner::write_json(const std::vector<BenchResult>& results) const
+{
+    std::ofstream out(config_.json_path);
+    out << "{\n  \"repetitions\": " << config_.repetitions
+        << ",\n  \"warmup\": " << config_.warmup
+        << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\""
+            << ", \"threads\": " << r.threads
+            << ", \"median\": " << r.median << ", \"min\": " << r.min << ", \"max\": " << r.max
+            << ", \"stddev\": " << r.stddev
+            << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90
+            << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999 << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    std::cout << "Wrote " << results.size() << " results to " << config_.json_path << std::endl;
+}
+
+int BenchRunner::compare_baseline(const std::vector<BenchResult>& results) const
+{
+    std::ifstream in(config_.baseline_path);
+    if (!in)
+    {
+        std::cerr << "Cannot read baseline " << config_.baseline_path << std::endl;
+        return 1;
+    }
+
+    // name,threads -> median from a CSV written by an earlier run
+    std::map<std::pair<std::string, size_t>, double> baseline;
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line))
+    {
+        std::stringstream row(line);
+        std::string name, unit, threads, reps, median;
+        std::getline(row, name, ',');
+        std::getline(row, unit, ',');
+        std::getline(row, threads, ',');
+        std::getline(row, reps, ',');
+        std::getline(row, median, ',');
+        if (!median.empty())
+        {
+            baseline[{name, std::stoul(threads)}] = std::stod(median);
+        }
+    }
+
+    int regressions = 0;
+    for (const auto& r : results)
+    {
+        auto it = baseline.find({r.name, r.threads});
+        if (it == baseline.end() || it->second <= 0)
+        {
+            continue;
+        }
+        double change = r.median / it->second - 1;
+        if (change < -config_.tolerance)
+        {
+            regressions++;
+            std::cout << "REGRESSION " << r.name << " @" << r.threads << " threads: "
+                << std::fixed << std::setprecision(1) << 100 * change << "%" << std::endl;
+        }
+    }
+    std::cout << regressions << " regression(s) against " << config_.baseline_path << std::endl;
+    return regressions;
+}
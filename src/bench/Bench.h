@@ -0,0 +1,134 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * What one repetition of a benchmark measured.
+ * ops / seconds gives throughput, latencies_ns (optional) feed the percentiles.
+ */
+struct Measurement
+{
+    double ops = 0;
+    double seconds = 0;
+    std::vector<double> latencies_ns;
+};
+
+/**
+ * A benchmark is run once per thread count in the sweep
+ */
+struct BenchCase
+{
+    std::string name;
+    std::string unit; // what one op is, e.g. "tasks" or "increments"
+    std::function<Measurement(size_t threads)> run;
+};
+
+/**
+ * Summary of every repetition of one case at one thread count
+ */
+struct BenchResult
+{
+    std::string name;
+    std::string unit;
+    size_t threads = 0;
+    size_t repetitions = 0;
+
+    // throughput in ops/sec across repetitions
+    double median = 0;
+    double min = 0;
+    double max = 0;
+    double stddev = 0;
+
+    // latency percentiles in ns, zero when the case records none
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double p999 = 0;
+};
+
+struct BenchConfig
+{
+    int warmup = 1;
+    int repetitions = 5;
+    std::vector<size_t> threads = {1, 2, 4, 8};
+    std::string filter;
+    std::string csv_path;
+    std::string json_path;
+
+    // Fail the run if a median drops more than tolerance below the baseline CSV
+    std::string baseline_path;
+    double tolerance = 0.10;
+
+    // Shrinks every case's problem size, for smoke runs
+    bool quick = false;
+
+    // Size of the synthetic log the file_scan cases read, before --quick scaling
+    size_t scan_megabytes = 2048;
+};
+
+class BenchRunner
+{
+public:
+    explicit BenchRunner(BenchConfig config);
+
+    void add(std::string name, std::string unit, std::function<Measurement(size_t threads)> run);
+
+    const BenchConfig& config() const;
+
+    /**
+     * Scale a problem size down when running in quick mode
+     */
+    size_t scaled(size_t n) const;
+
+    /**
+     * Run every case matching the filter, print a table and write any requested reports.
+     * Returns the number of regressions against the baseline.
+     */
+    int run();
+
+private:
+    BenchResult summarise(const BenchCase& bench, size_t threads, std::vector<Measurement>& reps) const;
+    void write_csv(const std::vector<BenchResult>& results) const;
+    void write_json(const std::vector<BenchResult>& results) const;
+    int compare_baseline(const std::vector<BenchResult>& results) const;
+
+    BenchConfig config_;
+    std::vector<BenchCase> cases_;
+};
+
+/**
+ * Time a callable, in seconds
+ */
+template <typename F>
+double time_seconds(F&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double percentile(std::vector<double>& sorted, double p);
+
+void register_pool_benchmarks(BenchRunner& runner);
+void register_fork_join_benchmarks(BenchRunner& runner);
+void register_condition_benchmarks(BenchRunner& runner);
+void register_mutex_benchmarks(BenchRunner& runner);
+void register_pipeline_benchmarks(BenchRunner& runner);
+void register_simd_benchmarks(BenchRunner& runner);
+void register_hash_map_benchmarks(BenchRunner& runner);
+void register_executor_benchmarks(BenchRunner& runner);
+void register_ipc_benchmarks(BenchRunner& runner);
+void register_combining_benchmarks(BenchRunner& runner);
+void register_sharded_benchmarks(BenchRunner& runner);
+void register_file_scan_benchmarks(BenchRunner& runner);
+
+#endif // BENCH_H
@@ -0,0 +1,132 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+    void usage()
+    {
+        std::cout << "usage: threading_bench [options]\n"
+            << "  --filter NAME       only run benchmarks whose name contains NAME\n"
+            << "  --threads 1,2,4     thread counts to sweep (default 1,2,4,8)\n"
+            << "  --reps N            measured repetitions per point, at least 1 (default 5)\n"
+            << "  --warmup N          unmeasured repetitions per point (default 1)\n"
+            << "  --csv FILE          write results as CSV\n"
+            << "  --json FILE         write results as JSON\n"
+            << "  --baseline FILE     compare medians against an earlier CSV\n"
+            << "  --tolerance F       allowed slowdown against the baseline (default 0.10)\n"
+            << "  --quick             shrink problem sizes for a smoke run\n"
+            << "  --scan-size MB      synthetic log size for the file_scan cases (default 2048)\n";
+    }
+
+    // The whole of text as a count of at least min; std::stoul alone accepts "5x" and "-1"
+    size_t parse_count(const std::string& text, size_t min = 0)
+    {
+        size_t used = 0;
+        size_t value = text.empty() || text[0] == '-' ? 0 : std::stoul(text, &used);
+        if (used == 0 || used != text.size() || value < min)
+        {
+            throw std::invalid_argument(text);
+        }
+        return value;
+    }
+
+    double parse_fraction(const std::string& text)
+    {
+        size_t used = 0;
+        double value = std::stod(text, &used);
+        if (used != text.size() || !(value >= 0))
+        {
+            throw std::invalid_argument(text);
+        }
+        return value;
+    }
+
+    std::vector<size_t> parse_list(const std::string& text)
+    {
+        std::vector<size_t> values;
+        std::stringstream in(text);
+        std::string item;
+        while (std::getline(in, item, ','))
+        {
+            values.push_back(parse_count(item, 1));
+        }
+        if (values.empty())
+        {
+            throw std::invalid_argument(text);
+        }
+        return values;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig config;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << arg << " needs a value" << std::endl;
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        try
+        {
+            if (arg == "--filter") config.filter = next();
+            else if (arg == "--threads") config.threads = parse_list(next());
+            else if (arg == "--reps") config.repetitions = static_cast<int>(parse_count(next(), 1));
+            else if (arg == "--warmup") config.warmup = static_cast<int>(parse_count(next()));
+            else if (arg == "--csv") config.csv_path = next();
+            else if (arg == "--json") config.json_path = next();
+            else if (arg == "--baseline") config.baseline_path = next();
+            else if (arg == "--tolerance") config.tolerance = parse_fraction(next());
+            else if (arg == "--quick") config.quick = true;
+            else if (arg == "--scan-size") config.scan_megabytes = parse_count(next(), 1);
+            else
+            {
+                usage();
+                return arg == "--help" ? 0 : 2;
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "bad value for " << arg << ": " << argv[i] << std::endl;
+            usage();
+            return 2;
+        }
+    }
+
+    std::cout << "Threading benchmarks, hardware concurrency " << std::thread::hardware_concurrency()
+        << ", " << config.repetitions << " reps after " << config.warmup << " warm-up" << std::endl << std::endl;
+
+    BenchRunner runner(config);
+    register_pool_benchmarks(runner);
+    register_fork_join_benchmarks(runner);
+    register_condition_benchmarks(runner);
+    register_mutex_benchmarks(runner);
+    register_pipeline_benchmarks(runner);
+    register_simd_benchmarks(runner);
+    register_hash_map_benchmarks(runner);
+    register_executor_benchmarks(runner);
+    register_ipc_benchmarks(runner);
+    register_combining_benchmarks(runner);
+    register_sharded_benchmarks(runner);
+    register_file_scan_benchmarks(runner);
+
+    return runner.run() == 0 ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "Condition.h"
+#include "FlatCombining.h"
+#include "Mutexes.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    template <typename F>
+    double run_team(size_t threads, F&& body)
+    {
+        return time_seconds([&]
+        {
+            std::vector<std::thread> team;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                team.emplace_back(body);
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+        });
+    }
+
+    /**
+     * The lock-free baseline: Vyukov's bounded MPMC queue, each cell carrying a
+     * sequence number that says whose turn it is. Callers spin when it is full
+     * or empty, which is fine for a benchmark where every thread pushes then pops.
+     */
+    template <typename T>
+    class LockFreeQueue
+    {
+    public:
+        explicit LockFreeQueue(size_t capacity) : mask_(round_pow2(capacity) - 1), cells_(new Cell[mask_ + 1])
+        {
+            for (size_t i = 0; i <= mask_; ++i)
+            {
+                cells_[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        void push(T item)
+        {
+            size_t pos = head_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = cells_[pos & mask_];
+                size_t seq = cell.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0 && head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.item = item;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return;
+                }
+                if (diff < 0)
+                {
+                    cpu_relax();
+                }
+                if (diff != 0)
+                {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        T pop()
+        {
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = cells_[pos & mask_];
+                size_t seq = cell.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0 && tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    T item = cell.item;
+                    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return item;
+                }
+                if (diff < 0)
+                {
+                    cpu_relax();
+                }
+                if (diff != 0)
+                {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> seq;
+            T item;
+        };
+
+        static size_t round_pow2(size_t n)
+        {
+            size_t p = 1;
+            while (p < n)
+            {
+                p <<= 1;
+            }
+            return p;
+        }
+
+        size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+    };
+
+    // Every thread pushes then pops, so nobody blocks for long and the queue itself is the bottleneck
+    template <typename Queue>
+    Measurement push_pop_pairs(Queue& queue, size_t threads, size_t num_ops)
+    {
+        Measurement m;
+        size_t per_thread = num_ops / threads;
+        m.seconds = run_team(threads, [&queue, per_thread]
+        {
+            for (size_t i = 0; i < per_thread; ++i)
+            {
+                queue.push(static_cast<int>(i));
+                queue.pop();
+            }
+        });
+        m.ops = per_thread * threads * 2;
+        return m;
+    }
+
+    template <typename Counter>
+    Measurement hammer_counter(Counter& counter, size_t threads, size_t num_ops)
+    {
+        Measurement m;
+        size_t per_thread = num_ops / threads;
+        m.seconds = run_team(threads, [&counter, per_thread]
+        {
+            for (size_t i = 0; i < per_thread; ++i)
+            {
+                counter.increment();
+            }
+        });
+        m.ops = per_thread * threads;
+        return m;
+    }
+
+    struct AtomicCounter
+    {
+        std::atomic<int> value{0};
+
+        void increment()
+        {
+            value.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+}
+
+void register_combining_benchmarks(BenchRunner& runner)
+{
+    const size_t num_ops = runner.scaled(1000000);
+    const size_t num_pairs = runner.scaled(200000);
+
+    // The same contended counter behind a mutex, an atomic and a combiner
+    runner.add("contended_counter_mutex", "increments", [num_ops](size_t threads)
+    {
+        ThreadSafeCounter counter;
+        return hammer_counter(counter, threads, num_ops);
+    });
+
+    runner.add("contended_counter_atomic", "increments", [num_ops](size_t threads)
+    {
+        AtomicCounter counter;
+        return hammer_counter(counter, threads, num_ops);
+    });
+
+    runner.add("contended_counter_combining", "increments", [num_ops](size_t threads)
+    {
+        CombiningCounter counter;
+        return hammer_counter(counter, threads, num_ops);
+    });
+
+    runner.add("contended_queue_mutex", "operations", [num_pairs](size_t threads)
+    {
+        BoundedBuffer<int> buffer(1024, false);
+        return push_pop_pairs(buffer, threads, num_pairs);
+    });
+
+    runner.add("contended_queue_lockfree", "operations", [num_pairs](size_t threads)
+    {
+        LockFreeQueue<int> queue(1024);
+        return push_pop_pairs(queue, threads, num_pairs);
+    });
+
+    runner.add("contended_queue_combining", "operations", [num_pairs](size_t threads)
+    {
+        CombiningBuffer<int> buffer(1024);
+        return push_pop_pairs(buffer, threads, num_pairs);
+    });
+}
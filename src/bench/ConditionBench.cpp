@@ -0,0 +1,91 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "Condition.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+void register_condition_benchmarks(BenchRunner& runner)
+{
+    const size_t num_items = runner.scaled(200000);
+    const size_t num_phases = runner.scaled(5000);
+
+    // Half the threads produce, half consume, through a small buffer
+    runner.add("bounded_buffer", "items", [num_items](size_t threads)
+    {
+        Measurement m;
+        BoundedBuffer<int> buffer(1024, false);
+        size_t pairs = std::max<size_t>(1, threads / 2);
+        size_t per_thread = num_items / pairs;
+
+        m.seconds = time_seconds([&]
+        {
+            std::vector<std::thread> team;
+            for (size_t p = 0; p < pairs; ++p)
+            {
+                team.emplace_back([&buffer, per_thread]
+                {
+                    for (size_t i = 0; i < per_thread; ++i)
+                    {
+                        buffer.push(static_cast<int>(i));
+                    }
+                });
+                team.emplace_back([&buffer, per_thread]
+                {
+                    for (size_t i = 0; i < per_thread; ++i)
+                    {
+                        buffer.pop();
+                    }
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+        });
+        m.ops = per_thread * pairs;
+        return m;
+    });
+
+    // Every thread crosses the same barrier repeatedly, latency is one full phase
+    runner.add("barrier_latency", "phases", [num_phases](size_t threads)
+    {
+        using Clock = std::chrono::steady_clock;
+        Measurement m;
+        m.latencies_ns.reserve(num_phases);
+        Barrier phase_barrier(threads);
+
+        m.seconds = time_seconds([&]
+        {
+            std::vector<std::thread> team;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                team.emplace_back([&, t]
+                {
+                    auto last = Clock::now();
+                    for (size_t i = 0; i < num_phases; ++i)
+                    {
+                        phase_barrier.arrive_and_wait();
+                        if (t == 0)
+                        {
+                            auto now = Clock::now();
+                            m.latencies_ns.push_back(std::chrono::duration<double, std::nano>(now - last).count());
+                            last = now;
+                        }
+                    }
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+        });
+        m.ops = num_phases;
+        return m;
+    });
+}
@@ -0,0 +1,98 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "Executors.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    constexpr int kBlockingPerThread = 20;
+    constexpr int kComputePerThread = 500;
+
+    void blocking_call()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    void compute(std::atomic<long>& sink)
+    {
+        long x = 0;
+        for (int i = 0; i < 20000; ++i)
+        {
+            x += i % 7;
+        }
+        sink.fetch_add(x, std::memory_order_relaxed);
+    }
+
+    void wait_until(const std::atomic<int>& counter, int target)
+    {
+        while (counter.load() < target)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void register_executor_benchmarks(BenchRunner& runner)
+{
+    const int scale = runner.config().quick ? 10 : 1;
+
+    // Blocking calls sharing the CPU pool with compute: workers sit in sleep
+    runner.add("mixed_blocking_cpu_pool", "compute tasks", [scale](size_t threads)
+    {
+        Measurement m;
+        PoolOptions options;
+        options.verbose = false;
+        ThreadPool pool(threads, options);
+        const int blocking = static_cast<int>(threads) * kBlockingPerThread / scale;
+        const int computing = static_cast<int>(threads) * kComputePerThread / scale;
+        std::atomic<int> computed{0};
+        std::atomic<long> sink{0};
+
+        m.seconds = time_seconds([&]
+        {
+            for (int i = 0; i < computing; ++i)
+            {
+                if (i % (computing / blocking) == 0)
+                {
+                    pool.enqueue(blocking_call);
+                }
+                pool.enqueue([&] { compute(sink); computed++; });
+            }
+            wait_until(computed, computing);
+        });
+        m.ops = computing;
+        return m;
+    });
+
+    // Same load, blocking calls offloaded to the elastic pool
+    runner.add("mixed_blocking_offloaded", "compute tasks", [scale](size_t threads)
+    {
+        Measurement m;
+        Executors executors(threads);
+        const int blocking = static_cast<int>(threads) * kBlockingPerThread / scale;
+        const int computing = static_cast<int>(threads) * kComputePerThread / scale;
+        std::atomic<int> computed{0};
+        std::atomic<long> sink{0};
+
+        m.seconds = time_seconds([&]
+        {
+            for (int i = 0; i < computing; ++i)
+            {
+                if (i % (computing / blocking) == 0)
+                {
+                    executors.offload_blocking(blocking_call);
+                }
+                executors.cpu().enqueue([&] { compute(sink); computed++; });
+            }
+            wait_until(computed, computing);
+        });
+        m.ops = computing;
+        return m;
+    });
+}
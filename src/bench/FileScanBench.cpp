@@ -0,0 +1,202 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "FileScan.h"
+#include "Pool.h"
+#include "TaskGroup.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    /**
+     * A synthetic access log in the temp directory, written on first use and
+     * removed at exit. Pages are flushed so a cold run can evict them.
+     */
+    class SyntheticLog
+    {
+    public:
+        explicit SyntheticLog(size_t bytes)
+            : path_((std::filesystem::temp_directory_path() / ("threading_bench_" + std::to_string(getpid()) + ".log"))
+                        .string())
+        {
+            std::ofstream out(path_, std::ios::binary);
+            std::string block;
+            for (uint64_t i = 0; block.size() < (1 << 20); ++i)
+            {
+                block += "2026-10-18T12:00:00 " + std::string(i % 50 == 0 ? "ERROR" : "INFO") + " latency_us="
+                    + std::to_string(100 + i * 7919 % 900) + " path=/api/items/" + std::to_string(i) + "\n";
+            }
+            for (size_t written = 0; written < bytes; written += block.size())
+            {
+                out.write(block.data(), static_cast<std::streamsize>(block.size()));
+            }
+            out.close();
+            int fd = open(path_.c_str(), O_RDONLY);
+            if (fd >= 0)
+            {
+                fdatasync(fd);
+                close(fd);
+            }
+            size_ = std::filesystem::file_size(path_);
+        }
+
+        ~SyntheticLog()
+        {
+            std::remove(path_.c_str());
+        }
+
+        const std::string& path() const
+        {
+            return path_;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        // Evict the file from the page cache so the next scan reads the disk
+        void drop_cache() const
+        {
+            int fd = open(path_.c_str(), O_RDONLY);
+            if (fd >= 0)
+            {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+            }
+        }
+
+    private:
+        std::string path_;
+        size_t size_ = 0;
+    };
+
+    struct LogTotals
+    {
+        uint64_t lines = 0;
+        uint64_t latency_us = 0;
+    };
+
+    LogTotals merge(LogTotals a, LogTotals b)
+    {
+        return LogTotals{a.lines + b.lines, a.latency_us + b.latency_us};
+    }
+
+    uint64_t parse_latency(std::string_view line)
+    {
+        size_t field = line.find("latency_us=");
+        uint64_t value = 0;
+        for (size_t i = field == std::string_view::npos ? line.size() : field + 11;
+             i < line.size() && line[i] >= '0' && line[i] <= '9'; ++i)
+        {
+            value = value * 10 + (line[i] - '0');
+        }
+        return value;
+    }
+
+    LogTotals scan_chunk(std::string_view chunk)
+    {
+        LogTotals totals;
+        for (size_t pos = 0; pos < chunk.size();)
+        {
+            size_t end = chunk.find('\n', pos);
+            if (end == std::string_view::npos)
+            {
+                end = chunk.size();
+            }
+            totals.lines++;
+            totals.latency_us += parse_latency(chunk.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        return totals;
+    }
+
+    PoolOptions quiet()
+    {
+        PoolOptions options;
+        options.verbose = false;
+        return options;
+    }
+}
+
+void register_file_scan_benchmarks(BenchRunner& runner)
+{
+    const size_t bytes = runner.scaled(runner.config().scan_megabytes) << 20;
+    // Shared by the cases and only written if one of them runs
+    auto log = std::make_shared<std::unique_ptr<SyntheticLog>>();
+    auto file = [log, bytes]() -> const SyntheticLog&
+    {
+        if (!*log)
+        {
+            *log = std::make_unique<SyntheticLog>(bytes);
+        }
+        return **log;
+    };
+
+    // Throughput is in GB/s: one op is a gigabyte scanned
+    runner.add("file_scan_mmap", "GB", [file](size_t threads)
+    {
+        Measurement m;
+        const SyntheticLog& log = file();
+        ThreadPool pool(threads, quiet());
+        m.seconds = time_seconds([&]
+        {
+            parallel_file_scan(pool, log.path(), scan_chunk, merge, LogTotals{});
+        });
+        m.ops = log.size() / 1e9;
+        return m;
+    });
+
+    // From disk rather than the page cache, where the readahead hints matter
+    runner.add("file_scan_mmap_cold", "GB", [file](size_t threads)
+    {
+        Measurement m;
+        const SyntheticLog& log = file();
+        ThreadPool pool(threads, quiet());
+        log.drop_cache();
+        m.seconds = time_seconds([&]
+        {
+            parallel_file_scan(pool, log.path(), scan_chunk, merge, LogTotals{});
+        });
+        m.ops = log.size() / 1e9;
+        return m;
+    });
+
+    // What it replaces: one thread reading lines with ifstream, one pool task per line
+    runner.add("file_scan_ifstream_enqueue", "GB", [file](size_t threads)
+    {
+        Measurement m;
+        const SyntheticLog& log = file();
+        ThreadPool pool(threads, quiet());
+        std::atomic<uint64_t> latency{0};
+        m.seconds = time_seconds([&]
+        {
+            TaskGroup group(pool);
+            std::ifstream in(log.path());
+            std::string line;
+            while (std::getline(in, line))
+            {
+                group.run([&latency, line]
+                {
+                    latency.fetch_add(parse_latency(line), std::memory_order_relaxed);
+                });
+            }
+            group.wait();
+        });
+        m.ops = log.size() / 1e9;
+        return m;
+    });
+}
@@ -0,0 +1,158 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "ConcurrentHashMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    /**
+     * Zipf(s) over [0, n): a few hot keys take most of the traffic, like per-client counters
+     */
+    class Zipf
+    {
+    public:
+        Zipf(size_t n, double s)
+        {
+            cdf_.reserve(n);
+            double total = 0;
+            for (size_t k = 1; k <= n; ++k)
+            {
+                total += 1.0 / std::pow(static_cast<double>(k), s);
+                cdf_.push_back(total);
+            }
+            for (auto& c : cdf_)
+            {
+                c /= total;
+            }
+        }
+
+        template <typename Rng>
+        uint64_t operator()(Rng& rng) const
+        {
+            double u = std::uniform_real_distribution<double>(0, 1)(rng);
+            return std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+        }
+
+    private:
+        std::vector<double> cdf_;
+    };
+
+    /**
+     * The baseline: one unordered_map behind one mutex
+     */
+    class LockedMap
+    {
+    public:
+        long fetch_add(uint64_t key, long delta)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            long& value = map_[key];
+            long previous = value;
+            value += delta;
+            return previous;
+        }
+
+        std::optional<long> find(uint64_t key) const
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = map_.find(key);
+            return it == map_.end() ? std::nullopt : std::optional<long>(it->second);
+        }
+
+    private:
+        mutable std::mutex mtx_;
+        std::unordered_map<uint64_t, long> map_;
+    };
+
+    /**
+     * 80% fetch_add / 20% find over pre-generated Zipfian keys
+     */
+    template <typename Map>
+    Measurement run_mix(size_t threads, const std::vector<std::vector<uint64_t>>& keys)
+    {
+        Measurement m;
+        Map map;
+        m.seconds = time_seconds([&]
+        {
+            std::vector<std::thread> team;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                team.emplace_back([&map, &stream = keys[t]]
+                {
+                    long seen = 0;
+                    for (size_t i = 0; i < stream.size(); ++i)
+                    {
+                        if (i % 5 == 4)
+                        {
+                            seen += map.find(stream[i]).value_or(0);
+                        }
+                        else
+                        {
+                            map.fetch_add(stream[i], 1);
+                        }
+                    }
+                    volatile long keep = seen;
+                    (void)keep;
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+        });
+        m.ops = static_cast<double>(threads) * keys[0].size();
+        return m;
+    }
+
+    std::vector<std::vector<uint64_t>> key_streams(size_t threads, size_t per_thread, const Zipf& zipf)
+    {
+        std::vector<std::vector<uint64_t>> streams(threads);
+        for (size_t t = 0; t < threads; ++t)
+        {
+            std::mt19937_64 rng(t + 1);
+            streams[t].reserve(per_thread);
+            for (size_t i = 0; i < per_thread; ++i)
+            {
+                // Spread the ranks so hot keys are not adjacent integers
+                streams[t].push_back(zipf(rng) * 0x9e3779b97f4a7c15ULL);
+            }
+        }
+        return streams;
+    }
+
+    struct StripedMap : ConcurrentHashMap<uint64_t, long>
+    {
+        StripedMap() : ConcurrentHashMap<uint64_t, long>(64)
+        {
+        }
+    };
+}
+
+void register_hash_map_benchmarks(BenchRunner& runner)
+{
+    const size_t per_thread = runner.scaled(200000);
+    auto zipf = std::make_shared<Zipf>(100000, 0.99);
+
+    runner.add("hashmap_locked_zipf", "ops", [per_thread, zipf](size_t threads)
+    {
+        return run_mix<LockedMap>(threads, key_streams(threads, per_thread, *zipf));
+    });
+
+    runner.add("hashmap_striped_zipf", "ops", [per_thread, zipf](size_t threads)
+    {
+        return run_mix<StripedMap>(threads, key_streams(threads, per_thread, *zipf));
+    });
+}
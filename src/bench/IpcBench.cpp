@@ -0,0 +1,313 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "SharedRing.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // One cache line, the size of a typical small event
+    struct Message
+    {
+        uint64_t seq;
+        uint64_t payload[7];
+    };
+
+    using Ring = SharedRing<Message>;
+
+    std::string ring_name(const char* use)
+    {
+        return std::string("/threading_bench_") + use + "_" + std::to_string(getpid());
+    }
+
+    // Run fn in a forked child and return its pid; the bench is single threaded here
+    template <typename F>
+    pid_t spawn(F fn)
+    {
+        pid_t child = fork();
+        if (child == 0)
+        {
+            fn();
+            _exit(0);
+        }
+        return child;
+    }
+
+    /**
+     * spawn() for a child that must open something first: fn(ready) calls
+     * ready() once it can serve, or returns without it. Returns the pid after
+     * the child called ready(), -1 (child reaped) if it never did, so the
+     * parent never blocks on a peer that is not there.
+     */
+    template <typename F>
+    pid_t spawn_ready(F fn)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            return -1;
+        }
+        pid_t child = fork();
+        if (child == 0)
+        {
+            close(fds[0]);
+            fn([fd = fds[1]]
+            {
+                const char byte = 1;
+                (void)!write(fd, &byte, 1);
+            });
+            _exit(0);
+        }
+        close(fds[1]);
+        char byte = 0;
+        // A child that exits without calling ready() closes the pipe: read returns 0
+        const ssize_t got = child < 0 ? 0 : read(fds[0], &byte, 1);
+        close(fds[0]);
+        if (got != 1)
+        {
+            if (child > 0)
+            {
+                waitpid(child, nullptr, 0);
+            }
+            return -1;
+        }
+        return child;
+    }
+
+    bool send_all(int fd, const void* data, size_t size)
+    {
+        auto* bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            ssize_t sent = send(fd, bytes, size, 0);
+            if (sent <= 0)
+            {
+                return false;
+            }
+            bytes += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    bool recv_all(int fd, void* data, size_t size)
+    {
+        auto* bytes = static_cast<char*>(data);
+        while (size > 0)
+        {
+            ssize_t got = recv(fd, bytes, size, 0);
+            if (got <= 0)
+            {
+                return false;
+            }
+            bytes += got;
+            size -= got;
+        }
+        return true;
+    }
+
+    // Split count messages over threads producers in this process
+    template <typename Send>
+    void produce_from(size_t threads, size_t count, Send send_one)
+    {
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            producers.emplace_back([&, t]
+            {
+                for (size_t i = t; i < count; i += threads)
+                {
+                    send_one(Message{i, {}});
+                }
+            });
+        }
+        for (auto& p : producers)
+        {
+            p.join();
+        }
+    }
+}
+
+void register_ipc_benchmarks(BenchRunner& runner)
+{
+    const size_t num_messages = runner.scaled(500000);
+    const size_t num_pings = runner.scaled(20000);
+
+    // threads producers in this process streaming to a consumer process
+    runner.add("ipc_ring_throughput", "messages", [num_messages](size_t threads)
+    {
+        Measurement m;
+        const std::string name = ring_name("stream");
+        auto ring = Ring::create(name, 1024, Ring::Role::Producer);
+        if (!ring)
+        {
+            return m;
+        }
+        pid_t child = spawn_ready([&name, num_messages](auto ready)
+        {
+            auto consumer = Ring::open(name, Ring::Role::Consumer);
+            if (!consumer)
+            {
+                return;
+            }
+            ready();
+            uint64_t sum = 0;
+            for (size_t i = 0; i < num_messages; ++i)
+            {
+                consumer->consume([&sum](const Message& msg) { sum += msg.seq; });
+            }
+        });
+        if (child < 0)
+        {
+            ring.reset();
+            Ring::unlink(name);
+            return m;
+        }
+        m.seconds = time_seconds([&]
+        {
+            produce_from(threads, num_messages, [&ring](const Message& msg) { ring->push(msg); });
+            waitpid(child, nullptr, 0);
+        });
+        ring.reset();
+        Ring::unlink(name);
+        m.ops = num_messages;
+        return m;
+    });
+
+    // Same stream over a Unix-domain socket, SOCK_SEQPACKET keeps messages whole across senders
+    runner.add("ipc_socket_throughput", "messages", [num_messages](size_t threads)
+    {
+        Measurement m;
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0)
+        {
+            return m;
+        }
+        pid_t child = spawn([&fds, num_messages]
+        {
+            close(fds[0]);
+            Message msg{};
+            uint64_t sum = 0;
+            for (size_t i = 0; i < num_messages && recv(fds[1], &msg, sizeof(msg), 0) == sizeof(msg); ++i)
+            {
+                sum += msg.seq;
+            }
+        });
+        close(fds[1]);
+        m.seconds = time_seconds([&]
+        {
+            produce_from(threads, num_messages, [&fds](const Message& msg)
+            {
+                send(fds[0], &msg, sizeof(msg), 0);
+            });
+            waitpid(child, nullptr, 0);
+        });
+        close(fds[0]);
+        m.ops = num_messages;
+        return m;
+    });
+
+    // Round trip to an echo process and back, one message in flight
+    runner.add("ipc_ring_latency", "round trips", [num_pings](size_t)
+    {
+        Measurement m;
+        const std::string to_name = ring_name("ping");
+        const std::string from_name = ring_name("pong");
+        auto to = Ring::create(to_name, 64, Ring::Role::Producer);
+        auto from = Ring::create(from_name, 64, Ring::Role::Consumer);
+        if (!to || !from)
+        {
+            return m;
+        }
+        pid_t child = spawn_ready([&to_name, &from_name, num_pings](auto ready)
+        {
+            auto requests = Ring::open(to_name, Ring::Role::Consumer);
+            auto replies = Ring::open(from_name, Ring::Role::Producer);
+            if (!requests || !replies)
+            {
+                return;
+            }
+            ready();
+            for (size_t i = 0; i < num_pings; ++i)
+            {
+                replies->push(requests->pop());
+            }
+        });
+        if (child < 0)
+        {
+            to.reset();
+            from.reset();
+            Ring::unlink(to_name);
+            Ring::unlink(from_name);
+            return m;
+        }
+
+        m.latencies_ns.reserve(num_pings);
+        m.seconds = time_seconds([&]
+        {
+            for (size_t i = 0; i < num_pings; ++i)
+            {
+                auto start = Clock::now();
+                to->push(Message{i, {}});
+                from->pop();
+                m.latencies_ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+            }
+        });
+        waitpid(child, nullptr, 0);
+        to.reset();
+        from.reset();
+        Ring::unlink(to_name);
+        Ring::unlink(from_name);
+        m.ops = num_pings;
+        return m;
+    });
+
+    runner.add("ipc_socket_latency", "round trips", [num_pings](size_t)
+    {
+        Measurement m;
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        {
+            return m;
+        }
+        pid_t child = spawn([&fds, num_pings]
+        {
+            close(fds[0]);
+            Message msg{};
+            for (size_t i = 0; i < num_pings && recv_all(fds[1], &msg, sizeof(msg)); ++i)
+            {
+                send_all(fds[1], &msg, sizeof(msg));
+            }
+        });
+        close(fds[1]);
+
+        m.latencies_ns.reserve(num_pings);
+        m.seconds = time_seconds([&]
+        {
+            for (size_t i = 0; i < num_pings; ++i)
+            {
+                auto start = Clock::now();
+                Message msg{i, {}};
+                send_all(fds[0], &msg, sizeof(msg));
+                recv_all(fds[0], &msg, sizeof(msg));
+                m.latencies_ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+            }
+        });
+        waitpid(child, nullptr, 0);
+        close(fds[0]);
+        m.ops = num_pings;
+        return m;
+    });
+}
@@ -0,0 +1,74 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "Mutexes.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    template <typename F>
+    double run_team(size_t threads, F&& body)
+    {
+        return time_seconds([&]
+        {
+            std::vector<std::thread> team;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                team.emplace_back(body);
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+        });
+    }
+}
+
+void register_mutex_benchmarks(BenchRunner& runner)
+{
+    const size_t num_ops = runner.scaled(1000000);
+
+    // Fixed total work split across the team, so flat is perfect scaling
+    runner.add("counter_scaling", "increments", [num_ops](size_t threads)
+    {
+        Measurement m;
+        ThreadSafeCounter counter;
+        size_t per_thread = num_ops / threads;
+        m.seconds = run_team(threads, [&counter, per_thread]
+        {
+            for (size_t i = 0; i < per_thread; ++i)
+            {
+                counter.increment();
+            }
+        });
+        m.ops = per_thread * threads;
+        return m;
+    });
+
+    // A slightly larger critical section over shared data
+    runner.add("lock_contention", "locks", [num_ops](size_t threads)
+    {
+        Measurement m;
+        std::mutex mtx;
+        std::vector<long long> shared(16, 0);
+        size_t per_thread = num_ops / threads;
+        m.seconds = run_team(threads, [&mtx, &shared, per_thread]
+        {
+            for (size_t i = 0; i < per_thread; ++i)
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                for (auto& v : shared)
+                {
+                    v += i;
+                }
+            }
+        });
+        m.ops = per_thread * threads;
+        return m;
+    });
+}
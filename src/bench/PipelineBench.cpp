@@ -0,0 +1,51 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "Pipeline.h"
+
+#include <atomic>
+
+void register_pipeline_benchmarks(BenchRunner& runner)
+{
+    const size_t num_items = runner.scaled(200000);
+
+    // Three stages, the middle one parallel, the last one in order
+    runner.add("pipeline_throughput", "items", [num_items](size_t threads)
+    {
+        Measurement m;
+        PoolOptions options;
+        options.verbose = false;
+        ThreadPool pool(threads, options);
+        long long total = 0;
+
+        m.seconds = time_seconds([&]
+        {
+            auto chain = make_pipeline<int>(pool)
+                .stage(StageOptions::parallel("square", threads, 64), [](int v)
+                {
+                    long long x = v;
+                    for (int i = 0; i < 20; ++i)
+                    {
+                        x = (x * x + i) % 1000003;
+                    }
+                    return x;
+                })
+                .stage(StageOptions::serial_in_order("sum", 64), [&total](long long x)
+                {
+                    total += x;
+                    return total;
+                })
+                .sink(StageOptions::parallel("drop", 1, 64), [](long long) {});
+
+            for (size_t i = 0; i < num_items; ++i)
+            {
+                chain.push(static_cast<int>(i));
+            }
+            chain.wait();
+        });
+        m.ops = num_items;
+        return m;
+    });
+}
@@ -0,0 +1,330 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "Pool.h"
+#include "TaskGroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    PoolOptions quiet()
+    {
+        PoolOptions options;
+        options.verbose = false;
+        return options;
+    }
+
+    // Many tiny tasks submitted from one thread: measures queue overhead
+    template <typename Pool>
+    void add_throughput(BenchRunner& runner, const char* name, size_t num_tasks)
+    {
+        runner.add(name, "tasks", [num_tasks](size_t threads)
+        {
+            Measurement m;
+            Pool pool(threads, quiet());
+            std::atomic<size_t> sink{0};
+            m.seconds = time_seconds([&]
+            {
+                for (size_t i = 0; i < num_tasks; ++i)
+                {
+                    pool.enqueue([&sink] { sink.fetch_add(1, std::memory_order_relaxed); });
+                }
+                while (sink.load() < num_tasks)
+                {
+                    std::this_thread::yield();
+                }
+            });
+            m.ops = num_tasks;
+            return m;
+        });
+    }
+
+    template <typename Pool>
+    void add_latency(BenchRunner& runner, const char* name, size_t num_pings, unsigned spin)
+    {
+        runner.add(name, "tasks", [num_pings, spin](size_t threads)
+        {
+            using Clock = std::chrono::steady_clock;
+            Measurement m;
+            m.latencies_ns.reserve(num_pings);
+            PoolOptions options = quiet();
+            options.spin_iterations = spin;
+            Pool pool(threads, options);
+
+            m.seconds = time_seconds([&]
+            {
+                for (size_t i = 0; i < num_pings; ++i)
+                {
+                    std::atomic<long long> started{0};
+                    auto submitted = Clock::now();
+                    pool.enqueue([&started]
+                    {
+                        started = Clock::now().time_since_epoch().count();
+                    });
+                    while (started.load() == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                    auto began = Clock::time_point(Clock::duration(started.load()));
+                    m.latencies_ns.push_back(std::chrono::duration<double, std::nano>(began - submitted).count());
+                }
+            });
+            m.ops = num_pings;
+            return m;
+        });
+    }
+}
+
+void register_pool_benchmarks(BenchRunner& runner)
+{
+    const size_t num_tasks = runner.scaled(200000);
+    const size_t num_pings = runner.scaled(20000);
+
+    add_throughput<ThreadPool>(runner, "pool_throughput", num_tasks);
+
+    // One task at a time: enqueue to start latency of an idle pool, workers
+    // sleeping at once or spinning a while first (see auto_tune())
+    add_latency<ThreadPool>(runner, "pool_latency", num_pings, 0);
+    add_latency<ThreadPool>(runner, "pool_latency_spin", num_pings, 2000);
+
+    // The same on the compile-time presets: lean is ThroughputThreadPool (no
+    // stats, inline tasks), lowlat is LowLatencyThreadPool (adds a ring queue
+    // and workers that never sleep)
+    add_throughput<ThroughputThreadPool>(runner, "pool_throughput_lean", num_tasks);
+    add_throughput<LowLatencyThreadPool>(runner, "pool_throughput_lowlat", num_tasks);
+    add_latency<ThroughputThreadPool>(runner, "pool_latency_lean", num_pings, 0);
+    add_latency<LowLatencyThreadPool>(runner, "pool_latency_lowlat", num_pings, 2000);
+
+    // Tasks that each fill a scratch buffer and add what they found to one
+    // result: a fresh buffer per task and a mutex-guarded total, as in
+    // shared_state(), against a worker-local buffer and partial folded at the end
+    const size_t num_reduce = runner.scaled(100000);
+    const size_t scratch = 256;
+    runner.add("reduce_result_mtx", "tasks", [num_reduce, scratch](size_t threads)
+    {
+        Measurement m;
+        ThreadPool pool(threads, quiet());
+        std::mutex result_mtx;
+        uint64_t total = 0;
+        m.seconds = time_seconds([&]
+        {
+            TaskGroup group(pool);
+            for (size_t i = 0; i < num_reduce; ++i)
+            {
+                group.run([&, i]
+                {
+                    std::vector<uint64_t> buffer(scratch);
+                    for (size_t j = 0; j < scratch; ++j)
+                    {
+                        buffer[j] = i * j;
+                    }
+                    uint64_t sum = 0;
+                    for (uint64_t value : buffer)
+                    {
+                        sum += value;
+                    }
+                    std::lock_guard<std::mutex> lock(result_mtx);
+                    total += sum;
+                });
+            }
+            group.wait();
+        });
+        m.ops = num_reduce;
+        return m;
+    });
+
+    runner.add("reduce_worker_local", "tasks", [num_reduce, scratch](size_t threads)
+    {
+        Measurement m;
+        ThreadPool pool(threads, quiet());
+        struct Partial;
+        uint64_t total = 0;
+        m.seconds = time_seconds([&]
+        {
+            TaskGroup group(pool);
+            for (size_t i = 0; i < num_reduce; ++i)
+            {
+                group.run([&pool, i, scratch]
+                {
+                    auto& buffer = pool.worker_local<std::vector<uint64_t>>();
+                    buffer.resize(scratch);
+                    for (size_t j = 0; j < scratch; ++j)
+                    {
+                        buffer[j] = i * j;
+                    }
+                    uint64_t sum = 0;
+                    for (uint64_t value : buffer)
+                    {
+                        sum += value;
+                    }
+                    pool.worker_local<uint64_t, Partial>() += sum;
+                });
+            }
+            group.wait();
+            pool.combine_worker_locals<uint64_t, Partial>([&total](uint64_t& partial)
+            {
+                total += std::exchange(partial, 0);
+            });
+        });
+        m.ops = num_reduce;
+        return m;
+    });
+}
+
+namespace
+{
+    /**
+     * Fork-join without joins: every task spawns its children and the caller
+     * waits for the count of outstanding tasks to reach zero
+     */
+    struct ForkJoin
+    {
+        ThreadPool& pool;
+        std::atomic<long> pending{0};
+
+        template <typename F>
+        void spawn(F&& fn)
+        {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            pool.enqueue([this, fn = std::forward<F>(fn)]() mutable
+            {
+                fn();
+                pending.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        void wait()
+        {
+            while (pending.load(std::memory_order_acquire) != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    void fib(ForkJoin& fj, std::atomic<long>& result, int n)
+    {
+        if (n < 2)
+        {
+            result.fetch_add(n, std::memory_order_relaxed);
+            return;
+        }
+        fj.spawn([&fj, &result, n] { fib(fj, result, n - 1); });
+        fj.spawn([&fj, &result, n] { fib(fj, result, n - 2); });
+    }
+
+    void quicksort(ForkJoin& fj, int* lo, int* hi)
+    {
+        if (hi - lo < 2048)
+        {
+            std::sort(lo, hi);
+            return;
+        }
+        int a = *lo, b = lo[(hi - lo) / 2], c = *(hi - 1);
+        int pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+        int* mid1 = std::partition(lo, hi, [pivot](int v) { return v < pivot; });
+        int* mid2 = std::partition(mid1, hi, [pivot](int v) { return v == pivot; });
+        fj.spawn([&fj, lo, mid1] { quicksort(fj, lo, mid1); });
+        fj.spawn([&fj, mid2, hi] { quicksort(fj, mid2, hi); });
+    }
+
+    // Real joins: each task waits for its children through a TaskGroup
+    long fib_join(ThreadPool& pool, int n)
+    {
+        if (n < 12)
+        {
+            return n < 2 ? n : fib_join(pool, n - 1) + fib_join(pool, n - 2);
+        }
+        long a = 0;
+        long b = 0;
+        TaskGroup group(pool);
+        group.run([&pool, &a, n] { a = fib_join(pool, n - 1); });
+        group.run([&pool, &b, n] { b = fib_join(pool, n - 2); });
+        group.wait();
+        return a + b;
+    }
+
+    void add_fork_join(BenchRunner& runner, const char* suffix, bool local_batching)
+    {
+        const int fib_n = runner.config().quick ? 18 : 25;
+        const size_t sort_size = runner.scaled(2000000);
+
+        runner.add(std::string("fib_") + suffix, "tasks", [fib_n, local_batching](size_t threads)
+        {
+            Measurement m;
+            PoolOptions options = quiet();
+            options.local_batching = local_batching;
+            ThreadPool pool(threads, options);
+            ForkJoin fj{pool};
+            std::atomic<long> result{0};
+
+            m.seconds = time_seconds([&]
+            {
+                fj.spawn([&fj, &result, fib_n] { fib(fj, result, fib_n); });
+                fj.wait();
+            });
+            m.ops = pool.get_completed_tasks();
+            return m;
+        });
+
+        runner.add(std::string("quicksort_") + suffix, "elements", [sort_size, local_batching](size_t threads)
+        {
+            Measurement m;
+            PoolOptions options = quiet();
+            options.local_batching = local_batching;
+            ThreadPool pool(threads, options);
+            ForkJoin fj{pool};
+
+            std::vector<int> data(sort_size);
+            uint32_t x = 12345;
+            for (auto& v : data)
+            {
+                x = x * 1664525 + 1013904223;
+                v = static_cast<int>(x >> 8);
+            }
+
+            m.seconds = time_seconds([&]
+            {
+                fj.spawn([&fj, &data] { quicksort(fj, data.data(), data.data() + data.size()); });
+                fj.wait();
+            });
+            m.ops = std::is_sorted(data.begin(), data.end()) ? sort_size : 0;
+            return m;
+        });
+    }
+}
+
+void register_fork_join_benchmarks(BenchRunner& runner)
+{
+    add_fork_join(runner, "local_batching", true);
+    add_fork_join(runner, "shared_queue", false);
+
+    const int join_n = runner.config().quick ? 22 : 30;
+    runner.add("fib_task_group", "tasks", [join_n](size_t threads)
+    {
+        Measurement m;
+        PoolOptions options = quiet();
+        options.local_batching = true;
+        ThreadPool pool(threads, options);
+        long result = 0;
+        m.seconds = time_seconds([&]
+        {
+            TaskGroup group(pool);
+            group.run([&pool, &result, join_n] { result = fib_join(pool, join_n); });
+            group.wait();
+        });
+        m.ops = pool.get_completed_tasks();
+        return m;
+    });
+}
@@ -0,0 +1,165 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "ConcurrentHashMap.h"
+#include "Pool.h"
+#include "ShardedExecutor.h"
+#include "TaskGroup.h"
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    // Top bit of a request marks a read, the rest is the key
+    constexpr uint64_t kRead = uint64_t{1} << 63;
+    // Requests forwarded to another core per message
+    constexpr size_t kForwardBatch = 32;
+
+    struct KvShard
+    {
+        std::unordered_map<uint64_t, long> map;
+        long seen = 0;
+
+        void apply(uint64_t request)
+        {
+            if (request & kRead)
+            {
+                auto it = map.find(request & ~kRead);
+                seen += it == map.end() ? 0 : it->second;
+            }
+            else
+            {
+                map[request]++;
+            }
+        }
+    };
+
+    size_t owner_of(uint64_t key, size_t cores)
+    {
+        // Multiplicative hash so neighbouring keys land on different cores
+        return static_cast<size_t>(((key & ~kRead) * 0x9e3779b97f4a7c15ULL) >> 32) % cores;
+    }
+
+    /**
+     * One stream per client: 80% increments, 20% reads, uniform over the key space
+     */
+    std::vector<std::vector<uint64_t>> request_streams(size_t clients, size_t per_client, uint64_t keys)
+    {
+        std::vector<std::vector<uint64_t>> streams(clients);
+        for (size_t c = 0; c < clients; ++c)
+        {
+            std::mt19937_64 rng(c + 1);
+            std::uniform_int_distribution<uint64_t> key(0, keys - 1);
+            streams[c].reserve(per_client);
+            for (size_t i = 0; i < per_client; ++i)
+            {
+                streams[c].push_back(key(rng) | (i % 5 == 4 ? kRead : 0));
+            }
+        }
+        return streams;
+    }
+}
+
+void register_sharded_benchmarks(BenchRunner& runner)
+{
+    const size_t per_client = runner.scaled(200000);
+    const uint64_t num_keys = 1 << 16;
+
+    // Every core serves its own clients; a request for a key another core owns
+    // travels there in a batch over the pair's mailbox
+    runner.add("kv_thread_per_core", "requests", [per_client, num_keys](size_t threads)
+    {
+        Measurement m;
+        auto streams = request_streams(threads, per_client, num_keys);
+        ShardedExecutor<KvShard> executor(threads);
+        m.seconds = time_seconds([&]
+        {
+            for (size_t core = 0; core < threads; ++core)
+            {
+                executor.submit_to(core, [&executor, &stream = streams[core], threads](KvShard& shard)
+                {
+                    const size_t me = executor.current_core();
+                    std::vector<std::vector<uint64_t>> outgoing(threads);
+                    auto forward = [&executor, &outgoing](size_t to)
+                    {
+                        executor.submit_to(to, [batch = std::move(outgoing[to])](KvShard& remote)
+                        {
+                            for (uint64_t request : batch)
+                            {
+                                remote.apply(request);
+                            }
+                        });
+                        outgoing[to].clear();
+                    };
+                    for (uint64_t request : stream)
+                    {
+                        size_t owner = owner_of(request, threads);
+                        if (owner == me)
+                        {
+                            shard.apply(request);
+                            continue;
+                        }
+                        outgoing[owner].push_back(request);
+                        if (outgoing[owner].size() == kForwardBatch)
+                        {
+                            forward(owner);
+                        }
+                    }
+                    for (size_t to = 0; to < threads; ++to)
+                    {
+                        if (!outgoing[to].empty())
+                        {
+                            forward(to);
+                        }
+                    }
+                });
+            }
+            executor.wait_idle();
+        });
+        m.ops = static_cast<double>(threads) * per_client;
+        return m;
+    });
+
+    // The same clients as pool tasks sharing one lock-striped map
+    runner.add("kv_thread_pool", "requests", [per_client, num_keys](size_t threads)
+    {
+        Measurement m;
+        auto streams = request_streams(threads, per_client, num_keys);
+        PoolOptions options;
+        options.verbose = false;
+        ThreadPool pool(threads, options);
+        ConcurrentHashMap<uint64_t, long> map;
+        m.seconds = time_seconds([&]
+        {
+            TaskGroup group(pool);
+            for (size_t client = 0; client < threads; ++client)
+            {
+                group.run([&map, &stream = streams[client]]
+                {
+                    long seen = 0;
+                    for (uint64_t request : stream)
+                    {
+                        if (request & kRead)
+                        {
+                            seen += map.find(request & ~kRead).value_or(0);
+                        }
+                        else
+                        {
+                            map.fetch_add(request, 1);
+                        }
+                    }
+                    volatile long keep = seen;
+                    (void)keep;
+                });
+            }
+            group.wait();
+        });
+        m.ops = static_cast<double>(threads) * per_client;
+        return m;
+    });
+}
@@ -0,0 +1,76 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Bench.h"
+#include "Kernels.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t kIterations = 1000000;
+
+    /**
+     * compute_task-shaped work: one kernel call per value, values split into
+     * contiguous blocks across a pool of the swept size
+     */
+    template <typename Kernel>
+    Measurement run_batch(size_t threads, size_t num_values, Kernel kernel)
+    {
+        Measurement m;
+        PoolOptions options;
+        options.verbose = false;
+        ThreadPool pool(threads, options);
+
+        std::vector<int> values;
+        for (size_t i = 0; i < num_values; ++i)
+        {
+            values.push_back(100 + static_cast<int>(i % 50));
+        }
+        std::vector<uint64_t> results(values.size());
+
+        m.seconds = time_seconds([&]
+        {
+            pool.parallel_for_blocks(values.size(), 4, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    results[i] = kernel(static_cast<uint32_t>(values[i]));
+                }
+            });
+        });
+        m.ops = static_cast<double>(num_values) * kIterations;
+        return m;
+    }
+}
+
+void register_simd_benchmarks(BenchRunner& runner)
+{
+    const size_t num_values = runner.scaled(64);
+
+    runner.add("modsum_naive", "elements", [num_values](size_t threads)
+    {
+        return run_batch(threads, num_values, [](uint32_t value)
+        {
+            return mod_sum_naive(0, kIterations, value);
+        });
+    });
+
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512})
+    {
+        if (!simd_supported(level))
+        {
+            continue;
+        }
+        ModSumKernel kernel = mod_sum_kernel(level);
+        runner.add(std::string("modsum_") + simd_name(level), "elements", [num_values, kernel](size_t threads)
+        {
+            return run_batch(threads, num_values, [kernel](uint32_t value)
+            {
+                return kernel(0, kIterations, Divisor(value));
+            });
+        });
+    }
+}
@@ -0,0 +1,145 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "FlatCombining.h"
+
+#include "Futex.h"
+
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace combining_detail
+{
+    namespace
+    {
+        struct SlotRegistry
+        {
+            std::mutex mtx;
+            std::vector<size_t> released;
+            size_t next = 0;
+        };
+
+        SlotRegistry& registry()
+        {
+            static SlotRegistry instance;
+            return instance;
+        }
+    }
+
+    SlotLease::SlotLease()
+    {
+        SlotRegistry& slots = registry();
+        std::lock_guard<std::mutex> lock(slots.mtx);
+        if (slots.released.empty())
+        {
+            index = slots.next++;
+        }
+        else
+        {
+            index = slots.released.back();
+            slots.released.pop_back();
+        }
+    }
+
+    SlotLease::~SlotLease()
+    {
+        SlotRegistry& slots = registry();
+        std::lock_guard<std::mutex> lock(slots.mtx);
+        slots.released.push_back(index);
+    }
+
+    void park(std::atomic<uint32_t>& word, uint32_t expected)
+    {
+        futex_wait(word, expected);
+    }
+
+    void wake(std::atomic<uint32_t>& word)
+    {
+        futex_wake_all(word);
+    }
+}
+
+void CombiningCounter::increment()
+{
+    FlatCombiner<State>::Op op;
+    op.delta = 1;
+    combiner_.execute(op);
+}
+
+void CombiningCounter::decrement()
+{
+    FlatCombiner<State>::Op op;
+    op.delta = -1;
+    combiner_.execute(op);
+}
+
+int CombiningCounter::get() const
+{
+    FlatCombiner<State>::Op op;
+    combiner_.execute(op);
+    return op.value;
+}
+
+double CombiningCounter::average_batch() const
+{
+    return combiner_.average_batch();
+}
+
+void flat_combining()
+{
+    std::cout << "example 11: Flat Combining" << std::endl;
+
+    // thread_safe_class() again, but one thread applies everyone's increments
+    CombiningCounter counter;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&counter, i]
+        {
+            for (int j = 0; j < 10000; ++j)
+            {
+                i == 3 ? counter.decrement() : counter.increment();
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    std::cout << "Final counter value (should be 20000): " << counter.get() << std::endl;
+    std::cout << "Operations per combining turn: " << counter.average_batch() << std::endl;
+
+    // Producers and consumers meeting in the same batch
+    CombiningBuffer<int> buffer(8);
+    threads.clear();
+    long long total = 0;
+    std::mutex total_mtx;
+    for (int i = 0; i < 2; ++i)
+    {
+        threads.emplace_back([&buffer]
+        {
+            for (int j = 1; j <= 5000; ++j)
+            {
+                buffer.push(j);
+            }
+        });
+        threads.emplace_back([&buffer, &total, &total_mtx]
+        {
+            long long sum = 0;
+            for (int j = 0; j < 5000; ++j)
+            {
+                sum += buffer.pop();
+            }
+            std::lock_guard<std::mutex> lock(total_mtx);
+            total += sum;
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    std::cout << "Buffer moved items totalling " << total << " (should be 25005000), "
+        << buffer.average_batch() << " ops per turn" << std::endl;
+}
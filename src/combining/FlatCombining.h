@@ -0,0 +1,379 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef FLATCOMBINING_H
+#define FLATCOMBINING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <utility>
+
+#include "Pool.h"
+#include "SchedPoint.h"
+
+namespace combining_detail
+{
+    // Publication records per combiner; threads past this many apply their ops under the lock directly
+    constexpr size_t kMaxRecords = 128;
+
+    /**
+     * A small index per live thread, shared by every combiner and handed to a
+     * new thread once its owner exits, so record arrays stay dense
+     */
+    struct SlotLease
+    {
+        size_t index;
+
+        SlotLease();
+        ~SlotLease();
+    };
+
+    inline size_t thread_slot()
+    {
+        thread_local SlotLease lease;
+        return lease.index;
+    }
+
+    // Private futex on a record's state word
+    void park(std::atomic<uint32_t>& word, uint32_t expected);
+    void wake(std::atomic<uint32_t>& word);
+}
+
+/**
+ * Flat combining (Hendler, Incze, Shavit, Tzafrir, 2010) around a sequential
+ * structure S. Instead of every thread taking the lock for its own operation,
+ * a thread publishes the operation in its own cache-line record and whichever
+ * thread gets the lock applies every published operation in one pass, while
+ * the others spin on their record. The structure's cache lines stay with the
+ * combiner instead of bouncing between threads.
+ *
+ * S provides a default-constructible `Op` carrying arguments and results, and
+ * `bool apply(Op&)`. Returning false leaves the op published, say a pop from
+ * an empty queue: the combiner keeps making passes while they change
+ * something, so a push and a pop published together are matched in the same
+ * batch. An owner whose op is still pending sleeps on its record until a
+ * later combiner applies it.
+ */
+template <typename S>
+class FlatCombiner
+{
+public:
+    using Op = typename S::Op;
+
+    template <typename... Args>
+    explicit FlatCombiner(Args&&... args)
+        : structure_(std::forward<Args>(args)...), records_(new Record[combining_detail::kMaxRecords])
+    {
+    }
+
+    FlatCombiner(const FlatCombiner&) = delete;
+    FlatCombiner& operator=(const FlatCombiner&) = delete;
+
+    // Apply op to the structure, blocking while S leaves it pending; results come back in op
+    void execute(Op& op)
+    {
+        THREADING_SCHED_POINT();
+        const size_t slot = combining_detail::thread_slot();
+        if (slot >= combining_detail::kMaxRecords)
+        {
+            execute_alone(op);
+            return;
+        }
+        raise_active(slot + 1);
+
+        Record& record = records_[slot];
+        record.op = std::move(op);
+        record.state.store(Pending, std::memory_order_release);
+
+        unsigned spins = 0;
+        while (record.state.load(std::memory_order_acquire) != Idle)
+        {
+            if (!try_lock())
+            {
+                // Someone else is combining and will probably pick this record up
+                if (++spins < kSpinRounds)
+                {
+                    cpu_relax();
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            const bool cut_short = combine();
+            unlock();
+            spins = 0;
+            if (cut_short)
+            {
+                // The last pass still changed the structure, this op may fit now: combine again
+                continue;
+            }
+
+            // The structure could not take it; any later change is followed by another pass
+            uint32_t expected = Pending;
+            if (record.state.compare_exchange_strong(expected, Parked, std::memory_order_acq_rel))
+            {
+                while (record.state.load(std::memory_order_acquire) == Parked)
+                {
+                    combining_detail::park(record.state, Parked);
+                }
+            }
+        }
+        op = std::move(record.op);
+    }
+
+    // Mean operations applied per turn holding the lock, how much contention was merged
+    double average_batch() const
+    {
+        uint64_t combines = combines_.load(std::memory_order_relaxed);
+        return combines == 0 ? 0.0 : static_cast<double>(applied_.load(std::memory_order_relaxed)) / combines;
+    }
+
+private:
+    // Idle doubles as done: the owner stops waiting once the combiner resets it
+    enum : uint32_t
+    {
+        Idle,
+        Pending,
+        Parked // pending and its owner is asleep on the state word
+    };
+
+    static constexpr unsigned kSpinRounds = 256;
+    // After this many productive passes parked owners are woken to combine for themselves
+    static constexpr unsigned kMaxPasses = 4;
+
+    struct alignas(64) Record
+    {
+        std::atomic<uint32_t> state{Idle};
+        Op op{};
+    };
+
+    bool try_lock()
+    {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock()
+    {
+        locked_.store(false, std::memory_order_release);
+    }
+
+    void raise_active(size_t count)
+    {
+        size_t seen = active_.load(std::memory_order_relaxed);
+        while (seen < count && !active_.compare_exchange_weak(seen, count, std::memory_order_release))
+        {
+        }
+    }
+
+    void finish(Record& record)
+    {
+        if (record.state.exchange(Idle, std::memory_order_acq_rel) == Parked)
+        {
+            combining_detail::wake(record.state);
+        }
+    }
+
+    /**
+     * Holding the lock: apply pending ops until a pass changes nothing or
+     * leaves nothing behind. Returns true when it stopped at kMaxPasses with
+     * the last pass still making progress past a refused op, which may have
+     * become applicable; parked owners are woken for it, the caller has to retry.
+     */
+    bool combine()
+    {
+        THREADING_SCHED_POINT();
+        const size_t active = active_.load(std::memory_order_acquire);
+        uint64_t applied = 0;
+        unsigned passes = 0;
+        bool progress = true;
+        bool refused = true;
+        while (progress && refused && passes < kMaxPasses)
+        {
+            progress = false;
+            refused = false;
+            passes++;
+            for (size_t i = 0; i < active; ++i)
+            {
+                Record& record = records_[i];
+                if (record.state.load(std::memory_order_acquire) == Idle)
+                {
+                    continue;
+                }
+                if (structure_.apply(record.op))
+                {
+                    finish(record);
+                    progress = true;
+                    applied++;
+                }
+                else
+                {
+                    refused = true;
+                }
+            }
+        }
+        if (progress && refused)
+        {
+            // The last pass still changed the structure, so a parked op might fit now
+            for (size_t i = 0; i < active; ++i)
+            {
+                uint32_t expected = Parked;
+                if (records_[i].state.compare_exchange_strong(expected, Pending, std::memory_order_acq_rel))
+                {
+                    combining_detail::wake(records_[i].state);
+                }
+            }
+        }
+        // Only the lock holder writes these, no need for a locked add
+        combines_.store(combines_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        applied_.store(applied_.load(std::memory_order_relaxed) + applied, std::memory_order_relaxed);
+        return progress && refused;
+    }
+
+    // No record for this thread: take the lock for its own op, serving the others while there
+    void execute_alone(Op& op)
+    {
+        while (true)
+        {
+            while (!try_lock())
+            {
+                std::this_thread::yield();
+            }
+            const bool done = structure_.apply(op);
+            combine();
+            unlock();
+            if (done)
+            {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    S structure_;
+    std::unique_ptr<Record[]> records_;
+    alignas(64) std::atomic<bool> locked_{false};
+    std::atomic<size_t> active_{0}; // records in use, a prefix of records_
+    std::atomic<uint64_t> combines_{0};
+    std::atomic<uint64_t> applied_{0};
+};
+
+/**
+ * ThreadSafeCounter with increments combined: under contention one thread
+ * applies everyone's deltas while the rest wait on their own cache line
+ */
+class CombiningCounter
+{
+public:
+    void increment();
+
+    void decrement();
+
+    int get() const;
+
+    double average_batch() const;
+
+private:
+    struct State
+    {
+        struct Op
+        {
+            int delta = 0;
+            int value = 0;
+        };
+
+        int value = 0;
+
+        bool apply(Op& op)
+        {
+            value += op.delta;
+            op.value = value;
+            return true;
+        }
+    };
+
+    mutable FlatCombiner<State> combiner_;
+};
+
+/**
+ * BoundedBuffer with flat combining: pushes and pops published together are
+ * applied in one pass, a pop taking an item pushed in the same batch. push()
+ * blocks while full and pop() while empty. T must be default-constructible.
+ */
+template <typename T>
+class CombiningBuffer
+{
+public:
+    explicit CombiningBuffer(size_t capacity) : combiner_(capacity)
+    {
+    }
+
+    void push(T item)
+    {
+        typename State::Op op;
+        op.push = true;
+        op.item = std::move(item);
+        combiner_.execute(op);
+    }
+
+    T pop()
+    {
+        typename State::Op op;
+        combiner_.execute(op);
+        return std::move(op.item);
+    }
+
+    double average_batch() const
+    {
+        return combiner_.average_batch();
+    }
+
+private:
+    struct State
+    {
+        struct Op
+        {
+            bool push = false;
+            T item{};
+        };
+
+        std::queue<T> items;
+        size_t capacity;
+
+        explicit State(size_t c) : capacity(c)
+        {
+        }
+
+        bool apply(Op& op)
+        {
+            if (op.push)
+            {
+                if (items.size() >= capacity)
+                {
+                    return false;
+                }
+                items.push(std::move(op.item));
+                return true;
+            }
+            if (items.empty())
+            {
+                return false;
+            }
+            op.item = std::move(items.front());
+            items.pop();
+            return true;
+        }
+    };
+
+    FlatCombiner<State> combiner_;
+};
+
+void flat_combining();
+
+#endif // FLATCOMBINING_H
@@ -157,6 +157,27 @@ void bounded_buffer()
     c2.join();
 }
 
+Barrier::Barrier(size_t count) : count_(count), waiting_(0), generation_(0)
+{
+}
+
+void Barrier::arrive_and_wait()
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    size_t generation = generation_;
+
+    if (++waiting_ == count_)
+    {
+        // Last one in releases everyone and resets for the next phase
+        waiting_ = 0;
+        generation_++;
+        cv_.notify_all();
+        return;
+    }
+
+    cv_.wait(lock, [&] { return generation != generation_; });
+}
+
 void barrier()
 {
     std::cout << "example 4: Barrier Synchronization" << std::endl;
@@ -10,6 +10,8 @@
 #include <condition_variable>
 #include <queue>
 
+#include "SchedPoint.h"
+
 void wait_notify();
 
 void producer_consumer();
@@ -20,30 +22,37 @@ class BoundedBuffer
 private:
     std::queue<T> buffer_;
     size_t capacity_;
+    bool verbose_;
     std::mutex mtx_;
     std::condition_variable not_full_;
     std::condition_variable not_empty_;
 
 public:
-    BoundedBuffer(size_t capacity) : capacity_(capacity)
+    BoundedBuffer(size_t capacity, bool verbose = true) : capacity_(capacity), verbose_(verbose)
     {
     }
 
     void push(T item)
     {
+        THREADING_SCHED_POINT();
         std::unique_lock<std::mutex> lock(mtx_);
 
         // Wait until buffer is not full
         not_full_.wait(lock, [this] { return buffer_.size() < capacity_; });
 
         buffer_.push(item);
-        std::cout << "Pushed item (buffer size: " << buffer_.size() << ")\n";
+        THREADING_SCHED_POINT();
+        if (verbose_)
+        {
+            std::cout << "Pushed item (buffer size: " << buffer_.size() << ")\n";
+        }
 
         not_empty_.notify_one();
     }
 
     T pop()
     {
+        THREADING_SCHED_POINT();
         std::unique_lock<std::mutex> lock(mtx_);
 
         // Wait until buffer is not empty
@@ -51,7 +60,11 @@ public:
 
         T item = buffer_.front();
         buffer_.pop();
-        std::cout << "Popped item (buffer size: " << buffer_.size() << ")\n";
+        THREADING_SCHED_POINT();
+        if (verbose_)
+        {
+            std::cout << "Popped item (buffer size: " << buffer_.size() << ")\n";
+        }
 
         not_full_.notify_one();
         return item;
@@ -60,6 +73,24 @@ public:
 
 void bounded_buffer();
 
+/**
+ * Reusable barrier: the generation counter lets the same object be waited on phase after phase
+ */
+class Barrier
+{
+private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    size_t count_;
+    size_t waiting_;
+    size_t generation_;
+
+public:
+    Barrier(size_t count);
+
+    void arrive_and_wait();
+};
+
 void barrier();
 
 #endif // CONDITION_H
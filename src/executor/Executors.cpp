@@ -0,0 +1,145 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Executors.h"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+BlockingExecutor::BlockingExecutor(size_t max_threads, std::chrono::milliseconds keep_alive)
+    : max_threads_(std::max<size_t>(1, max_threads)), keep_alive_(keep_alive), threads_(0), idle_(0), stop_(false)
+{
+}
+
+BlockingExecutor::~BlockingExecutor()
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    stop_ = true;
+    cv_.notify_all();
+    // Threads are detached, wait until the last one has left worker_thread
+    exit_cv_.wait(lock, [this] { return threads_ == 0; });
+}
+
+PoolStats BlockingExecutor::stats()
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return TaskStats::combine({&stats_}, threads_, tasks_.size());
+}
+
+void BlockingExecutor::worker_thread()
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true)
+    {
+        idle_++;
+        bool woken = cv_.wait_for(lock, keep_alive_, [this] { return stop_ || !tasks_.empty(); });
+        idle_--;
+
+        if (tasks_.empty())
+        {
+            // Drained and stopping, or idle for a whole keep-alive
+            if (stop_ || !woken)
+            {
+                break;
+            }
+            continue;
+        }
+
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+
+        auto start = Clock::now();
+        task.fn();
+        stats_.record(start - task.enqueued, Clock::now() - start);
+
+        lock.lock();
+    }
+
+    threads_--;
+    exit_cv_.notify_all();
+}
+
+PoolOptions Executors::cpu_defaults()
+{
+    PoolOptions options;
+    options.verbose = false;
+    options.track_blocking = true;
+    return options;
+}
+
+Executors::Executors(size_t cpu_threads, size_t max_blocking_threads, PoolOptions cpu_options)
+    : cpu_(cpu_threads, cpu_options), blocking_(max_blocking_threads)
+{
+}
+
+ThreadPool& Executors::cpu()
+{
+    return cpu_;
+}
+
+BlockingExecutor& Executors::blocking()
+{
+    return blocking_;
+}
+
+void Executors::print_stats(std::ostream& out)
+{
+    out << "  cpu pool:      " << cpu_.stats() << std::endl;
+    out << "  blocking pool: " << blocking_.stats() << std::endl;
+}
+
+void blocking_offload(size_t threads, const PoolOptions& options)
+{
+    std::cout << "example 8: Offloading Blocking Work" << std::endl;
+
+    PoolOptions cpu_options = options;
+    cpu_options.verbose = false;
+    cpu_options.track_blocking = true;
+    Executors executors(threads, 64, cpu_options);
+    std::atomic<int> done{0};
+
+    // A request() that sleeps misrouted onto the CPU pool shows up as a blocked task
+    executors.cpu().enqueue([&done]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        done++;
+    });
+
+    // The right way: block on the elastic pool, continue on the CPU pool
+    for (int i = 1; i <= 6; ++i)
+    {
+        executors.offload_blocking([i]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return "response " + std::to_string(i);
+        }, [&done](std::string response)
+        {
+            std::cout << "Handling " << response << " on a CPU worker" << std::endl;
+            done++;
+        });
+    }
+
+    for (int i = 1; i <= 4; ++i)
+    {
+        executors.cpu().enqueue([i, &done]
+        {
+            // compute_task without its sleep, pure CPU work
+            int result = 0;
+            for (int j = 0; j < 1000000; ++j)
+            {
+                result += j % (100 + i);
+            }
+            std::cout << "Task: " << i << " result: " << result << std::endl;
+            done++;
+        });
+    }
+
+    while (done < 11)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    executors.print_stats(std::cout);
+}
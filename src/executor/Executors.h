@@ -0,0 +1,145 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef EXECUTORS_H
+#define EXECUTORS_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Pool.h"
+
+/**
+ * Elastic pool for blocking work: sleeps, file and socket calls, anything
+ * that waits instead of computing. Threads are added whenever a task arrives
+ * and none is idle, up to max_threads, and retire after keep_alive idle.
+ */
+class BlockingExecutor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit BlockingExecutor(size_t max_threads = 64,
+                              std::chrono::milliseconds keep_alive = std::chrono::milliseconds(2000));
+    ~BlockingExecutor();
+
+    /**
+     * Queue task, starting a thread for it if none is idle. Throws std::system_error
+     * if that thread cannot be started; the task is then not queued at all.
+     */
+    template <typename F>
+    void enqueue(F&& task)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        tasks_.push_back(Task{std::function<void()>(std::forward<F>(task)), Clock::now()});
+        // Grow only when the queue has outrun the idle threads
+        if (tasks_.size() > idle_ && threads_ < max_threads_)
+        {
+            // Started under the lock, so a failed spawn (EAGAIN) takes back exactly the task it pushed
+            try
+            {
+                std::thread([this] { worker_thread(); }).detach();
+            }
+            catch (...)
+            {
+                tasks_.pop_back();
+                throw;
+            }
+            threads_++;
+            return;
+        }
+        lock.unlock();
+        cv_.notify_one();
+    }
+
+    PoolStats stats();
+
+private:
+    struct Task
+    {
+        std::function<void()> fn;
+        Clock::time_point enqueued;
+    };
+
+    void worker_thread();
+
+    std::deque<Task> tasks_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable exit_cv_;
+    size_t max_threads_;
+    std::chrono::milliseconds keep_alive_;
+    size_t threads_;
+    size_t idle_;
+    bool stop_;
+    TaskStats stats_;
+};
+
+/**
+ * A core-sized ThreadPool for computation paired with a BlockingExecutor.
+ * Compute tasks go to cpu(); anything that blocks is handed over with
+ * offload_blocking() so it never occupies a CPU worker.
+ */
+class Executors
+{
+public:
+    explicit Executors(size_t cpu_threads = std::max(1u, std::thread::hardware_concurrency()),
+                       size_t max_blocking_threads = 64, PoolOptions cpu_options = cpu_defaults());
+
+    ThreadPool& cpu();
+    BlockingExecutor& blocking();
+
+    /**
+     * Run fn on the blocking pool, then then(result) (or then() for void fn)
+     * back on the CPU pool
+     */
+    template <typename F, typename Then>
+    void offload_blocking(F fn, Then then)
+    {
+        blocking_.enqueue([this, fn = std::move(fn), then = std::move(then)]() mutable
+        {
+            if constexpr (std::is_void_v<std::invoke_result_t<F&>>)
+            {
+                fn();
+                cpu_.enqueue(std::move(then));
+            }
+            else
+            {
+                cpu_.enqueue([then = std::move(then), result = fn()]() mutable { then(std::move(result)); });
+            }
+        });
+    }
+
+    /**
+     * Fire-and-forget blocking work with nothing to continue on the CPU pool
+     */
+    template <typename F>
+    void offload_blocking(F fn)
+    {
+        blocking_.enqueue(std::move(fn));
+    }
+
+    void print_stats(std::ostream& out);
+
+private:
+    static PoolOptions cpu_defaults();
+
+    // Declared first so it is destroyed last: blocking tasks finishing
+    // during shutdown still post their continuations here
+    ThreadPool cpu_;
+    BlockingExecutor blocking_;
+};
+
+void blocking_offload(size_t threads, const PoolOptions& options);
+
+#endif // EXECUTORS_H
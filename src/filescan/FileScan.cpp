@@ -0,0 +1,158 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "FileScan.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const char* data, size_t size) : data_(data), size_(size)
+{
+}
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<size_t>(st.st_size);
+    // mmap refuses a zero length; the mapping outlives the descriptor
+    void* data = size == 0 ? nullptr : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    return std::unique_ptr<MappedFile>(new MappedFile(static_cast<const char*>(data), size));
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+void MappedFile::advise_sequential() const
+{
+    if (data_)
+    {
+        madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const
+{
+    if (!data_ || offset >= size_)
+    {
+        return;
+    }
+    // madvise wants a page-aligned start
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t aligned = offset / page * page;
+    madvise(const_cast<char*>(data_) + aligned, std::min(size_, offset + length) - aligned, MADV_WILLNEED);
+}
+
+namespace filescan_detail
+{
+    size_t record_start(std::string_view text, size_t offset)
+    {
+        if (offset == 0 || offset >= text.size())
+        {
+            return std::min(offset, text.size());
+        }
+        size_t newline = text.find('\n', offset - 1);
+        return newline == std::string_view::npos ? text.size() : newline + 1;
+    }
+}
+
+void file_scan(size_t threads, const PoolOptions& options)
+{
+    std::cout << "example 13: Parallel File Scan" << std::endl;
+
+    // A synthetic access log, one request per line
+    const std::string path = (std::filesystem::temp_directory_path() / "threading_example.log").string();
+    {
+        std::ofstream out(path);
+        for (int i = 0; i < 200000; ++i)
+        {
+            out << "2026-10-18T12:00:00 " << (i % 50 == 0 ? "ERROR" : "INFO") << " latency_us=" << (100 + i % 900)
+                << " path=/api/items/" << i << "\n";
+        }
+    }
+
+    struct LogSummary
+    {
+        uint64_t lines = 0;
+        uint64_t errors = 0;
+        uint64_t latency_us = 0;
+    };
+
+    // Runs on string_views straight into the mapping, one chunk at a time
+    auto summarise = [](std::string_view chunk)
+    {
+        LogSummary summary;
+        for (size_t pos = 0; pos < chunk.size();)
+        {
+            size_t end = chunk.find('\n', pos);
+            std::string_view line = chunk.substr(pos, end == std::string_view::npos ? end : end - pos);
+            summary.lines++;
+            summary.errors += line.find(" ERROR ") != std::string_view::npos;
+            size_t field = line.find("latency_us=");
+            if (field != std::string_view::npos)
+            {
+                uint64_t value = 0;
+                for (size_t i = field + 11; i < line.size() && line[i] >= '0' && line[i] <= '9'; ++i)
+                {
+                    value = value * 10 + (line[i] - '0');
+                }
+                summary.latency_us += value;
+            }
+            pos = end == std::string_view::npos ? chunk.size() : end + 1;
+        }
+        return summary;
+    };
+    auto merge = [](LogSummary a, LogSummary b)
+    {
+        return LogSummary{a.lines + b.lines, a.errors + b.errors, a.latency_us + b.latency_us};
+    };
+
+    PoolOptions pool_options = options;
+    pool_options.verbose = false;
+    ThreadPool pool(threads, pool_options);
+    FileScanOptions scan;
+    scan.chunk_bytes = 1 << 20;
+
+    auto start = std::chrono::steady_clock::now();
+    auto summary = parallel_file_scan(pool, path, summarise, merge, LogSummary{}, scan);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto bytes = std::filesystem::file_size(path);
+    std::remove(path.c_str());
+
+    if (!summary)
+    {
+        std::cout << "Could not map " << path << std::endl;
+        return;
+    }
+    std::cout << "Lines: " << summary->lines << ", errors: " << summary->errors << ", mean latency "
+        << summary->latency_us / std::max<uint64_t>(1, summary->lines) << "us" << std::endl;
+    std::cout << "Scanned " << bytes / (1 << 20) << " MiB at " << bytes / seconds / 1e9 << " GB/s" << std::endl;
+}
@@ -0,0 +1,153 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef FILESCAN_H
+#define FILESCAN_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Pool.h"
+#include "TaskGroup.h"
+
+/**
+ * A whole file mapped read-only. The view stays valid while this lives.
+ */
+class MappedFile
+{
+public:
+    // nullptr when the file cannot be opened or mapped; an empty file maps to an empty view
+    static std::unique_ptr<MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view contents() const
+    {
+        return std::string_view(data_, size_);
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    // madvise(MADV_SEQUENTIAL): read ahead aggressively and drop pages behind the reader
+    void advise_sequential() const;
+    // madvise(MADV_WILLNEED) on [offset, offset + length): start reading it in now
+    void prefetch(size_t offset, size_t length) const;
+
+private:
+    MappedFile(const char* data, size_t size);
+
+    const char* data_;
+    size_t size_;
+};
+
+struct FileScanOptions
+{
+    // Bytes per chunk before aligning to a newline; a worker claims one chunk at a time
+    size_t chunk_bytes = 8 << 20;
+    // MADV_SEQUENTIAL on the mapping and MADV_WILLNEED on each chunk as it is claimed
+    bool readahead_hints = true;
+};
+
+namespace filescan_detail
+{
+    // Offset of the first record starting at or after offset: 0, or just past a newline
+    size_t record_start(std::string_view text, size_t offset);
+}
+
+/**
+ * Map the file at path and run chunk_fn over it on the pool. The file is cut
+ * into chunks of about options.chunk_bytes that end on a newline, so a record
+ * never straddles two; chunk_fn(std::string_view) sees the mapped bytes
+ * themselves, no copy, and returns a partial result R. Each participant (the
+ * caller and up to one helper per worker) folds the chunks it claims into its
+ * own partial with reduce(R, R), and the partials are folded together last,
+ * in participant order, starting from init.
+ *
+ * Boundaries are found by whichever participant claims the chunk, so nothing
+ * reads the file serially. Returns nullopt when the file cannot be mapped.
+ */
+template <typename R, typename ChunkFn, typename ReduceFn>
+std::optional<R> parallel_file_scan(ThreadPool& pool, const std::string& path, ChunkFn chunk_fn, ReduceFn reduce_fn,
+                                    R init, const FileScanOptions& options = FileScanOptions())
+{
+    auto file = MappedFile::open(path);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    if (options.readahead_hints)
+    {
+        file->advise_sequential();
+    }
+
+    const std::string_view text = file->contents();
+    const size_t chunk_bytes = std::max<size_t>(1, options.chunk_bytes);
+    const size_t chunks = (text.size() + chunk_bytes - 1) / chunk_bytes;
+
+    // One cache line per participant so their partials never share one; empty until it ran a chunk
+    struct alignas(64) Partial
+    {
+        std::optional<R> value;
+    };
+    const size_t helpers = std::min(pool.get_thread_count(), chunks > 0 ? chunks - 1 : 0);
+    std::vector<Partial> partials(helpers + 1);
+    std::atomic<size_t> next{0};
+
+    auto participate = [&](size_t who)
+    {
+        for (size_t c = next.fetch_add(1); c < chunks; c = next.fetch_add(1))
+        {
+            // A chunk owns the records that start inside its nominal range
+            const size_t begin = filescan_detail::record_start(text, c * chunk_bytes);
+            const size_t end = filescan_detail::record_start(text, std::min(text.size(), (c + 1) * chunk_bytes));
+            if (begin >= end)
+            {
+                continue;
+            }
+            if (options.readahead_hints)
+            {
+                file->prefetch(begin, end - begin);
+            }
+            R result = chunk_fn(text.substr(begin, end - begin));
+            std::optional<R>& mine = partials[who].value;
+            mine = mine ? reduce_fn(std::move(*mine), std::move(result)) : std::move(result);
+        }
+    };
+
+    {
+        TaskGroup group(pool);
+        for (size_t who = 1; who <= helpers; ++who)
+        {
+            group.run([&participate, who] { participate(who); });
+        }
+        participate(0);
+        group.wait();
+    }
+
+    for (auto& partial : partials)
+    {
+        if (partial.value)
+        {
+            init = reduce_fn(std::move(init), std::move(*partial.value));
+        }
+    }
+    return init;
+}
+
+void file_scan(size_t threads, const PoolOptions& options);
+
+#endif // FILESCAN_H
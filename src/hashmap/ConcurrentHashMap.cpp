@@ -0,0 +1,43 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "ConcurrentHashMap.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void concurrent_map()
+{
+    std::cout << "example 7: Concurrent Hash Map" << std::endl;
+
+    // Per-client request counters, updated by several threads at once
+    ConcurrentHashMap<std::string, int> requests(16);
+
+    auto serve = [&requests](int id)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            requests.fetch_add("client-" + std::to_string(i % 10), 1);
+        }
+        requests.upsert("worker-" + std::to_string(id), 1, [](int& seen) { seen++; });
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back(serve, i);
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    std::cout << "Distinct keys: " << requests.size() << std::endl;
+    std::cout << "client-3 requests (should be 400): " << requests.find("client-3").value_or(0) << std::endl;
+
+    requests.erase("worker-0");
+    std::cout << "worker-0 after erase: " << (requests.find("worker-0") ? "present" : "gone") << std::endl;
+}
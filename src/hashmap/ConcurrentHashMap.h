@@ -0,0 +1,336 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef CONCURRENT_HASH_MAP_H
+#define CONCURRENT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * Thread safe hash map built the way ThreadSafeCounter is, but with the lock
+ * striped: keys are spread over independent shards, each with its own mutex
+ * and its own flat open-addressed table (linear probing over contiguous
+ * control bytes and entries). A shard that fills up grows into a table twice
+ * the size and moves a few old slots across on every following operation,
+ * so no resize ever stops the world, or even one shard, for long.
+ *
+ * K and V must be default constructible.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ConcurrentHashMap
+{
+public:
+    explicit ConcurrentHashMap(size_t shards = 64, size_t initial_capacity = 16)
+    {
+        size_t count = 1;
+        while (count < shards)
+        {
+            count <<= 1;
+        }
+        shard_mask_ = count - 1;
+        shards_.reset(new Shard[count]);
+        for (size_t i = 0; i < count; ++i)
+        {
+            shards_[i].table = Table(round_up(initial_capacity / count));
+        }
+    }
+
+    /**
+     * Insert if absent, returns false when the key was already there
+     */
+    bool insert(const K& key, V value)
+    {
+        size_t h = hash(key);
+        Shard& shard = shard_for(h);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        if (lookup(shard, key, h))
+        {
+            return false;
+        }
+        insert_new(shard, key, h).second = std::move(value);
+        return true;
+    }
+
+    /**
+     * Insert init if absent, otherwise apply update(value) under the shard lock
+     */
+    template <typename F>
+    void upsert(const K& key, V init, F&& update)
+    {
+        size_t h = hash(key);
+        Shard& shard = shard_for(h);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        if (Entry* entry = lookup(shard, key, h))
+        {
+            update(entry->second);
+        }
+        else
+        {
+            insert_new(shard, key, h).second = std::move(init);
+        }
+    }
+
+    /**
+     * Atomically add delta (absent keys start from V{}), returns the previous value
+     */
+    V fetch_add(const K& key, V delta)
+    {
+        size_t h = hash(key);
+        Shard& shard = shard_for(h);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        Entry* entry = lookup(shard, key, h);
+        if (!entry)
+        {
+            entry = &insert_new(shard, key, h);
+        }
+        V previous = entry->second;
+        entry->second += delta;
+        return previous;
+    }
+
+    std::optional<V> find(const K& key) const
+    {
+        size_t h = hash(key);
+        Shard& shard = shard_for(h);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        if (Entry* entry = lookup(shard, key, h))
+        {
+            return entry->second;
+        }
+        return std::nullopt;
+    }
+
+    bool erase(const K& key)
+    {
+        size_t h = hash(key);
+        Shard& shard = shard_for(h);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        step_migration(shard);
+        for (Table* table : {&shard.table, &shard.old})
+        {
+            size_t idx = table->find(key, h);
+            if (idx != Table::npos)
+            {
+                table->ctrl[idx] = Deleted;
+                table->full--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t size() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i <= shard_mask_; ++i)
+        {
+            std::lock_guard<std::mutex> lock(shards_[i].mtx);
+            total += shards_[i].table.full + shards_[i].old.full;
+        }
+        return total;
+    }
+
+    /**
+     * Visit every entry, one shard locked at a time. Not a snapshot: entries
+     * changed in shards already visited are not seen again.
+     */
+    template <typename F>
+    void for_each(F&& fn) const
+    {
+        for (size_t i = 0; i <= shard_mask_; ++i)
+        {
+            std::lock_guard<std::mutex> lock(shards_[i].mtx);
+            for (const Table* table : {&shards_[i].table, &shards_[i].old})
+            {
+                for (size_t slot = 0; slot < table->ctrl.size(); ++slot)
+                {
+                    if (table->ctrl[slot] == Full)
+                    {
+                        fn(table->entries[slot].first, table->entries[slot].second);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    using Entry = std::pair<K, V>;
+
+    enum : uint8_t
+    {
+        Empty,
+        Full,
+        Deleted
+    };
+
+    // Old slots moved to the new table per operation while a shard is resizing
+    static constexpr size_t kMigrateStep = 16;
+
+    struct Table
+    {
+        static constexpr size_t npos = SIZE_MAX;
+
+        std::vector<uint8_t> ctrl;
+        std::vector<Entry> entries;
+        size_t mask = 0;
+        size_t used = 0; // full + deleted, what probing has to walk past
+        size_t full = 0;
+
+        Table() = default;
+
+        explicit Table(size_t capacity) : ctrl(capacity, Empty), entries(capacity), mask(capacity - 1)
+        {
+        }
+
+        size_t find(const K& key, size_t h) const
+        {
+            if (ctrl.empty())
+            {
+                return npos;
+            }
+            for (size_t i = h & mask;; i = (i + 1) & mask)
+            {
+                if (ctrl[i] == Empty)
+                {
+                    return npos;
+                }
+                if (ctrl[i] == Full && entries[i].first == key)
+                {
+                    return i;
+                }
+            }
+        }
+
+        // Caller guarantees the key is absent and there is a free slot
+        Entry& place(const K& key, size_t h)
+        {
+            size_t i = h & mask;
+            while (ctrl[i] == Full)
+            {
+                i = (i + 1) & mask;
+            }
+            if (ctrl[i] == Empty)
+            {
+                used++;
+            }
+            ctrl[i] = Full;
+            full++;
+            entries[i].first = key;
+            entries[i].second = V{};
+            return entries[i];
+        }
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mtx;
+        Table table;
+        Table old; // non-empty while migrating into table
+        size_t migrate_pos = 0;
+    };
+
+    static size_t round_up(size_t n)
+    {
+        size_t capacity = 8;
+        while (capacity < n)
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    size_t hash(const K& key) const
+    {
+        // std::hash is often the identity, scramble it before taking low bits
+        uint64_t h = static_cast<uint64_t>(hasher_(key)) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    Shard& shard_for(size_t h) const
+    {
+        return shards_[(h >> 48) & shard_mask_];
+    }
+
+    void step_migration(Shard& shard) const
+    {
+        if (shard.old.ctrl.empty())
+        {
+            return;
+        }
+        size_t end = std::min(shard.migrate_pos + kMigrateStep, shard.old.ctrl.size());
+        for (; shard.migrate_pos < end; ++shard.migrate_pos)
+        {
+            size_t i = shard.migrate_pos;
+            if (shard.old.ctrl[i] == Full)
+            {
+                // Tombstoned so erase(), lookup(), size() and for_each() stop seeing the old copy
+                shard.old.ctrl[i] = Deleted;
+                shard.old.full--;
+                Entry& moved = shard.table.place(shard.old.entries[i].first, hash(shard.old.entries[i].first));
+                moved.second = std::move(shard.old.entries[i].second);
+            }
+        }
+        if (shard.migrate_pos == shard.old.ctrl.size())
+        {
+            shard.old = Table();
+            shard.migrate_pos = 0;
+        }
+    }
+
+    // Finds the key in either table; one still in the old table is moved across first
+    Entry* lookup(Shard& shard, const K& key, size_t h) const
+    {
+        step_migration(shard);
+        size_t idx = shard.table.find(key, h);
+        if (idx != Table::npos)
+        {
+            return &shard.table.entries[idx];
+        }
+        idx = shard.old.find(key, h);
+        if (idx == Table::npos)
+        {
+            return nullptr;
+        }
+        shard.old.ctrl[idx] = Deleted;
+        shard.old.full--;
+        Entry& moved = shard.table.place(key, h);
+        moved.second = std::move(shard.old.entries[idx].second);
+        return &moved;
+    }
+
+    Entry& insert_new(Shard& shard, const K& key, size_t h)
+    {
+        Table& table = shard.table;
+        if ((table.used + 1) * 4 > table.ctrl.size() * 3)
+        {
+            // A resize still in flight is finished first, it is at most half our size
+            while (!shard.old.ctrl.empty())
+            {
+                step_migration(shard);
+            }
+            // Mostly tombstones: rebuild at the same size instead of doubling
+            size_t capacity = table.full * 2 < table.used ? table.ctrl.size() : table.ctrl.size() * 2;
+            shard.old = std::move(table);
+            shard.table = Table(capacity);
+            shard.migrate_pos = 0;
+            step_migration(shard);
+        }
+        return shard.table.place(key, h);
+    }
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_mask_ = 0;
+    Hash hasher_;
+};
+
+void concurrent_map();
+
+#endif // CONCURRENT_HASH_MAP_H
@@ -0,0 +1,489 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "SharedRing.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ipc_detail
+{
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x52494e47; // "RING"
+        constexpr uint32_t kVersion = 1;
+
+        enum SlotState : uint32_t
+        {
+            Free,
+            Writing,
+            Ready,
+            Reading,
+            Skipped // its producer died mid-write, consumers step over it
+        };
+
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must not hide a lock");
+
+        size_t round_up(size_t n, size_t align)
+        {
+            return (n + align - 1) / align * align;
+        }
+
+        std::string shm_name(const std::string& name)
+        {
+            return name.empty() || name[0] != '/' ? "/" + name : name;
+        }
+
+        // Not FUTEX_PRIVATE: the word lives in memory other processes map
+        void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, const timespec* timeout)
+        {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+        }
+
+        void futex_wake_all(std::atomic<uint32_t>& word)
+        {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        // A zombie passes kill(pid, 0) until its parent reaps it, but it will never release a slot
+        bool alive(int32_t pid)
+        {
+            if (kill(pid, 0) != 0 && errno == ESRCH)
+            {
+                return false;
+            }
+            std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+            std::string stat;
+            if (!std::getline(in, stat))
+            {
+                return true;
+            }
+            // pid (comm) state ..., comm may itself contain ") "
+            size_t comm_end = stat.rfind(')');
+            return comm_end == std::string::npos || comm_end + 2 >= stat.size() || stat[comm_end + 2] != 'Z';
+        }
+    }
+
+    struct Participant
+    {
+        int32_t pid; // 0 when the entry is free
+        uint32_t role;
+    };
+
+    struct SlotHeader
+    {
+        std::atomic<uint32_t> state;   // futex word
+        std::atomic<uint32_t> waiters; // sleeping on state, so wakers can skip the syscall
+        uint32_t owner;                // participant writing or reading it, guarded by the mutex
+        uint32_t reserved;
+        uint64_t ticket; // position in the stream, guarded by the mutex
+    };
+
+    struct Header
+    {
+        std::atomic<uint32_t> magic; // set last by the creator, openers wait for it
+        uint32_t version;
+        uint64_t capacity;
+        uint64_t slot_size;
+        uint64_t slot_stride;
+        uint64_t data_offset; // from a slot's start to its item
+        uint64_t slots_offset;
+
+        pthread_mutex_t mtx; // robust, process-shared; guards the fields below and slot claims
+        uint64_t head;       // next ticket a producer claims
+        uint64_t tail;       // next ticket a consumer claims
+        Participant participants[RingCore::kMaxParticipants];
+    };
+
+    RingCore::RingCore(void* base, size_t length, int fd)
+        : header_(static_cast<Header*>(base)), length_(length), fd_(fd), owner_(0)
+    {
+    }
+
+    std::unique_ptr<RingCore> RingCore::create(const std::string& name, size_t capacity, size_t slot_size,
+                                               size_t slot_align, Role role)
+    {
+        if (capacity == 0)
+        {
+            return nullptr;
+        }
+        const size_t data_offset = round_up(sizeof(SlotHeader), slot_align);
+        const size_t stride = round_up(data_offset + slot_size, 64);
+        const size_t slots_offset = round_up(sizeof(Header), 64);
+        const size_t length = slots_offset + stride * capacity;
+
+        int fd = shm_open(shm_name(name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        void* base = ftruncate(fd, static_cast<off_t>(length)) == 0
+                         ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                         : MAP_FAILED;
+        if (base == MAP_FAILED)
+        {
+            close(fd);
+            shm_unlink(shm_name(name).c_str());
+            return nullptr;
+        }
+
+        // ftruncate zero-fills: every slot starts Free with no waiters
+        auto* header = static_cast<Header*>(base);
+        header->version = kVersion;
+        header->capacity = capacity;
+        header->slot_size = slot_size;
+        header->slot_stride = stride;
+        header->data_offset = data_offset;
+        header->slots_offset = slots_offset;
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->mtx, &attr);
+        pthread_mutexattr_destroy(&attr);
+        header->magic.store(kMagic, std::memory_order_release);
+
+        auto core = std::unique_ptr<RingCore>(new RingCore(base, length, fd));
+        return core->register_as(role) ? std::move(core) : nullptr;
+    }
+
+    std::unique_ptr<RingCore> RingCore::open(const std::string& name, size_t slot_size, Role role)
+    {
+        int fd = shm_open(shm_name(name).c_str(), O_RDWR, 0600);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+
+        // The creator may still be sizing and initialising it
+        struct stat st{};
+        for (int tries = 0; tries < 1000; ++tries)
+        {
+            if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header))
+            {
+                void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (base == MAP_FAILED)
+                {
+                    break;
+                }
+                auto core = std::unique_ptr<RingCore>(new RingCore(base, st.st_size, fd));
+                if (core->header_->magic.load(std::memory_order_acquire) == kMagic)
+                {
+                    if (core->header_->version != kVersion || core->header_->slot_size != slot_size
+                        || !core->register_as(role))
+                    {
+                        return nullptr;
+                    }
+                    return core;
+                }
+                core.reset();
+                fd = shm_open(shm_name(name).c_str(), O_RDWR, 0600);
+                if (fd < 0)
+                {
+                    return nullptr;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        close(fd);
+        return nullptr;
+    }
+
+    bool RingCore::unlink(const std::string& name)
+    {
+        return shm_unlink(shm_name(name).c_str()) == 0;
+    }
+
+    RingCore::~RingCore()
+    {
+        if (owner_ != 0)
+        {
+            lock();
+            release_locked(owner_);
+            header_->participants[owner_ - 1] = Participant{0, 0};
+            unlock();
+        }
+        munmap(header_, length_);
+        close(fd_);
+    }
+
+    SlotHeader& RingCore::slot(size_t index) const
+    {
+        auto* base = reinterpret_cast<char*>(header_) + header_->slots_offset;
+        return *reinterpret_cast<SlotHeader*>(base + index * header_->slot_stride);
+    }
+
+    void* RingCore::data(size_t index) const
+    {
+        return reinterpret_cast<char*>(&slot(index)) + header_->data_offset;
+    }
+
+    size_t RingCore::capacity() const
+    {
+        return header_->capacity;
+    }
+
+    size_t RingCore::size()
+    {
+        lock();
+        size_t size = header_->head - header_->tail;
+        unlock();
+        return size;
+    }
+
+    void RingCore::lock()
+    {
+        // The previous holder died inside its critical section; claims are
+        // ordered so that recovering its slots is enough to repair the state
+        if (pthread_mutex_lock(&header_->mtx) == EOWNERDEAD)
+        {
+            recover_locked();
+            pthread_mutex_consistent(&header_->mtx);
+        }
+    }
+
+    void RingCore::unlock()
+    {
+        pthread_mutex_unlock(&header_->mtx);
+    }
+
+    bool RingCore::register_as(Role role)
+    {
+        lock();
+        recover_locked();
+        for (size_t i = 0; i < kMaxParticipants; ++i)
+        {
+            if (header_->participants[i].pid == 0)
+            {
+                header_->participants[i] = Participant{static_cast<int32_t>(getpid()), static_cast<uint32_t>(role)};
+                owner_ = static_cast<uint32_t>(i + 1);
+                break;
+            }
+        }
+        unlock();
+        return owner_ != 0;
+    }
+
+    void RingCore::recover_locked()
+    {
+        for (size_t i = 0; i < kMaxParticipants; ++i)
+        {
+            Participant& p = header_->participants[i];
+            if (p.pid != 0 && !alive(p.pid))
+            {
+                release_locked(static_cast<uint32_t>(i + 1));
+                p = Participant{0, 0};
+            }
+        }
+    }
+
+    /**
+     * Give back every slot owner holds. A claim sets the slot first and moves
+     * head or tail second, so a ticket past the cursor means the claim never
+     * finished and the slot simply returns to its previous state.
+     */
+    void RingCore::release_locked(uint32_t owner)
+    {
+        for (size_t i = 0; i < header_->capacity; ++i)
+        {
+            SlotHeader& s = slot(i);
+            const uint32_t state = s.state.load(std::memory_order_acquire);
+            if (s.owner != owner || (state != Writing && state != Reading))
+            {
+                continue;
+            }
+            s.owner = 0;
+            if (state == Writing)
+            {
+                s.state.store(s.ticket < header_->head ? Skipped : Free);
+            }
+            else
+            {
+                s.state.store(s.ticket < header_->tail ? Free : Ready);
+            }
+            futex_wake_all(s.state);
+        }
+    }
+
+    /**
+     * Sleep until the slot leaves state seen. The timeout doubles as the
+     * liveness check: whoever the slot is waiting on may have died.
+     */
+    void RingCore::wait_for(SlotHeader& s, uint32_t seen)
+    {
+        const timespec timeout{0, 50 * 1000 * 1000};
+        s.waiters.fetch_add(1);
+        futex_wait(s.state, seen, &timeout);
+        s.waiters.fetch_sub(1);
+        if (s.state.load() == seen)
+        {
+            lock();
+            recover_locked();
+            unlock();
+        }
+    }
+
+    size_t RingCore::begin_push(bool block)
+    {
+        while (true)
+        {
+            lock();
+            const size_t index = header_->head % header_->capacity;
+            SlotHeader& s = slot(index);
+            const uint32_t state = s.state.load(std::memory_order_acquire);
+            if (state == Free)
+            {
+                s.ticket = header_->head;
+                s.owner = owner_;
+                s.state.store(Writing, std::memory_order_relaxed);
+                header_->head++;
+                unlock();
+                return index;
+            }
+            unlock();
+            if (!block)
+            {
+                return kNone;
+            }
+            wait_for(s, state);
+        }
+    }
+
+    void RingCore::commit_push(size_t index)
+    {
+        SlotHeader& s = slot(index);
+        s.state.store(Ready);
+        if (s.waiters.load() != 0)
+        {
+            futex_wake_all(s.state);
+        }
+    }
+
+    size_t RingCore::begin_pop(bool block)
+    {
+        while (true)
+        {
+            lock();
+            const size_t index = header_->tail % header_->capacity;
+            SlotHeader& s = slot(index);
+            const uint32_t state = s.state.load(std::memory_order_acquire);
+            if ((state == Ready || state == Skipped) && s.ticket == header_->tail)
+            {
+                header_->tail++;
+                if (state == Ready)
+                {
+                    s.owner = owner_;
+                    s.state.store(Reading, std::memory_order_relaxed);
+                    unlock();
+                    return index;
+                }
+                s.state.store(Free);
+                unlock();
+                futex_wake_all(s.state);
+                continue;
+            }
+            unlock();
+            if (!block)
+            {
+                return kNone;
+            }
+            wait_for(s, state);
+        }
+    }
+
+    void RingCore::end_pop(size_t index)
+    {
+        SlotHeader& s = slot(index);
+        s.state.store(Free);
+        if (s.waiters.load() != 0)
+        {
+            futex_wake_all(s.state);
+        }
+    }
+}
+
+void shared_ring()
+{
+    std::cout << "example 10: Shared-Memory Ring Between Processes" << std::endl;
+
+    struct Reading
+    {
+        int sensor;
+        double value;
+    };
+
+    const std::string name = "/threading_example_ring";
+    SharedRing<Reading>::unlink(name);
+    auto ring = SharedRing<Reading>::create(name, 8, SharedRing<Reading>::Role::Consumer);
+    if (!ring)
+    {
+        std::cout << "Shared memory unavailable: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    // The producer is a separate process that finds the ring by name
+    std::cout.flush();
+    pid_t child = fork();
+    if (child == 0)
+    {
+        auto producer = SharedRing<Reading>::open(name, SharedRing<Reading>::Role::Producer);
+        for (int i = 0; producer && i < 20; ++i)
+        {
+            producer->produce([i](Reading& slot)
+            {
+                slot.sensor = i % 4;
+                slot.value = i * 1.5;
+            });
+        }
+        producer.reset();
+        _exit(0);
+    }
+
+    double total = 0;
+    for (int i = 0; i < 20; ++i)
+    {
+        // Read straight out of shared memory, no copy
+        ring->consume([&total](const Reading& reading) { total += reading.value; });
+    }
+    waitpid(child, nullptr, 0);
+    std::cout << "Consumed 20 readings from process " << child << ", total value " << total << std::endl;
+
+    // A producer that dies mid-write leaves a slot the consumer steps over
+    std::cout.flush();
+    child = fork();
+    if (child == 0)
+    {
+        auto producer = SharedRing<Reading>::open(name, SharedRing<Reading>::Role::Producer);
+        producer->push(Reading{1, 1.0});
+        producer->produce([](Reading&) { _exit(1); });
+        _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+    auto feeder = SharedRing<Reading>::open(name, SharedRing<Reading>::Role::Producer);
+    feeder->push(Reading{2, 2.0});
+    Reading first = ring->pop();
+    Reading second = ring->pop();
+    std::cout << "After a producer crash: read sensor " << first.sensor << " then sensor " << second.sensor
+        << ", crashed slot skipped" << std::endl;
+
+    ring.reset();
+    SharedRing<Reading>::unlink(name);
+}
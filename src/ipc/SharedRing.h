@@ -0,0 +1,201 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef SHAREDRING_H
+#define SHAREDRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "SchedPoint.h"
+
+namespace ipc_detail
+{
+    struct Header;
+    struct SlotHeader;
+
+    enum class Role : uint32_t
+    {
+        Producer = 1,
+        Consumer = 2
+    };
+
+    /**
+     * The untyped ring behind SharedRing<T>, living in a POSIX shared memory
+     * object. Slots move Free -> Writing -> Ready -> Reading -> Free; claims
+     * happen under a robust process-shared mutex, data is copied or read
+     * outside it, and the Writing -> Ready and Reading -> Free steps are plain
+     * atomic stores. Waiters sleep on the slot's state word with a
+     * process-shared futex.
+     *
+     * Every process registers in a pid table. When a participant dies, its
+     * half-written slots are skipped and the slots it was reading are freed,
+     * either by whoever next takes the mutex it died holding or by a waiter
+     * whose futex wait times out.
+     */
+    class RingCore
+    {
+    public:
+        static constexpr size_t kNone = static_cast<size_t>(-1);
+        static constexpr size_t kMaxParticipants = 64;
+
+        static std::unique_ptr<RingCore> create(const std::string& name, size_t capacity, size_t slot_size,
+                                                size_t slot_align, Role role);
+        static std::unique_ptr<RingCore> open(const std::string& name, size_t slot_size, Role role);
+        static bool unlink(const std::string& name);
+
+        ~RingCore();
+
+        RingCore(const RingCore&) = delete;
+        RingCore& operator=(const RingCore&) = delete;
+
+        // Claim the next slot to write or read, kNone when !block and there is none
+        size_t begin_push(bool block);
+        void commit_push(size_t slot);
+        size_t begin_pop(bool block);
+        void end_pop(size_t slot);
+
+        void* data(size_t slot) const;
+        size_t capacity() const;
+        size_t size();
+
+    private:
+        RingCore(void* base, size_t length, int fd);
+
+        SlotHeader& slot(size_t index) const;
+        void lock();
+        void unlock();
+        void wait_for(SlotHeader& slot, uint32_t seen);
+        void recover_locked();
+        void release_locked(uint32_t owner);
+        bool register_as(Role role);
+
+        Header* header_;
+        size_t length_;
+        int fd_;
+        uint32_t owner_; // index in the pid table + 1
+    };
+}
+
+/**
+ * BoundedBuffer across processes: a fixed-capacity FIFO in shared memory for
+ * trivially copyable T. One process create()s it by name, others open() it;
+ * any number of producers and consumers, each process and thread blocking in
+ * push() and pop() the way BoundedBuffer's callers do.
+ *
+ * produce() and consume() hand out the slot itself so large items are written
+ * and read in place without a copy. An item whose consumer dies mid-consume()
+ * is dropped; one whose producer dies mid-produce() is skipped.
+ */
+template <typename T>
+class SharedRing
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SharedRing moves T between processes as raw bytes");
+
+public:
+    // Recorded in the pid table, either end may push and pop
+    using Role = ipc_detail::Role;
+
+    // nullptr when the name already exists or shared memory is unavailable
+    static std::unique_ptr<SharedRing> create(const std::string& name, size_t capacity, Role role)
+    {
+        auto core = ipc_detail::RingCore::create(name, capacity, sizeof(T), alignof(T), role);
+        return core ? std::unique_ptr<SharedRing>(new SharedRing(std::move(core))) : nullptr;
+    }
+
+    // nullptr when there is no such ring, its slots are a different size, or the pid table is full
+    static std::unique_ptr<SharedRing> open(const std::string& name, Role role)
+    {
+        auto core = ipc_detail::RingCore::open(name, sizeof(T), role);
+        return core ? std::unique_ptr<SharedRing>(new SharedRing(std::move(core))) : nullptr;
+    }
+
+    // Remove the name; processes that have it open keep working
+    static bool unlink(const std::string& name)
+    {
+        return ipc_detail::RingCore::unlink(name);
+    }
+
+    void push(const T& item)
+    {
+        produce([&item](T& slot) { slot = item; });
+    }
+
+    bool try_push(const T& item)
+    {
+        size_t slot = core_->begin_push(false);
+        if (slot == ipc_detail::RingCore::kNone)
+        {
+            return false;
+        }
+        *static_cast<T*>(core_->data(slot)) = item;
+        core_->commit_push(slot);
+        return true;
+    }
+
+    T pop()
+    {
+        T item;
+        consume([&item](const T& slot) { item = slot; });
+        return item;
+    }
+
+    bool try_pop(T& item)
+    {
+        size_t slot = core_->begin_pop(false);
+        if (slot == ipc_detail::RingCore::kNone)
+        {
+            return false;
+        }
+        item = *static_cast<const T*>(core_->data(slot));
+        core_->end_pop(slot);
+        return true;
+    }
+
+    // Fill the next free slot in place, blocking while the ring is full
+    template <typename F>
+    void produce(F&& fill)
+    {
+        THREADING_SCHED_POINT();
+        size_t slot = core_->begin_push(true);
+        fill(*static_cast<T*>(core_->data(slot)));
+        core_->commit_push(slot);
+    }
+
+    // Read the oldest item in place, blocking while the ring is empty
+    template <typename F>
+    void consume(F&& read)
+    {
+        THREADING_SCHED_POINT();
+        size_t slot = core_->begin_pop(true);
+        read(*static_cast<const T*>(core_->data(slot)));
+        core_->end_pop(slot);
+    }
+
+    size_t capacity() const
+    {
+        return core_->capacity();
+    }
+
+    // Items written or being written and not yet claimed by a consumer
+    size_t size()
+    {
+        return core_->size();
+    }
+
+private:
+    explicit SharedRing(std::unique_ptr<ipc_detail::RingCore> core) : core_(std::move(core))
+    {
+    }
+
+    std::unique_ptr<ipc_detail::RingCore> core_;
+};
+
+void shared_ring();
+
+#endif // SHAREDRING_H
@@ -10,6 +10,8 @@
 #include <vector>
 #include <chrono>
 
+#include "SchedPoint.h"
+
 void race_condition()
 {
     std::cout << "example 1: Race Condition (UNSAFE)" << std::endl;
@@ -131,18 +133,21 @@ ThreadSafeCounter::ThreadSafeCounter() : value_(0)
 
 void ThreadSafeCounter::increment()
 {
+    THREADING_SCHED_POINT();
     std::lock_guard<std::mutex> lock(mtx_);
     ++value_;
 }
 
 void ThreadSafeCounter::decrement()
 {
+    THREADING_SCHED_POINT();
     std::lock_guard<std::mutex> lock(mtx_);
     --value_;
 }
 
 int ThreadSafeCounter::get() const
 {
+    THREADING_SCHED_POINT();
     std::lock_guard<std::mutex> lock(mtx_);
     return value_;
 }
@@ -0,0 +1,112 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "ShardedExecutor.h"
+
+#include "Futex.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <pthread.h>
+#include <sched.h>
+
+namespace percore_detail
+{
+    thread_local CurrentCore current;
+
+    std::vector<int> allowed_cpus()
+    {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        return cpus;
+    }
+
+    bool pin_current_thread(int cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    void park(std::atomic<uint32_t>& word, uint32_t expected)
+    {
+        futex_wait(word, expected);
+    }
+
+    void wake(std::atomic<uint32_t>& word)
+    {
+        futex_wake_all(word);
+    }
+
+    Latch::Latch(uint32_t count) : remaining_(count)
+    {
+    }
+
+    void Latch::count_down()
+    {
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            wake(remaining_);
+        }
+    }
+
+    void Latch::wait()
+    {
+        for (uint32_t n = remaining_.load(std::memory_order_acquire); n != 0;
+             n = remaining_.load(std::memory_order_acquire))
+        {
+            park(remaining_, n);
+        }
+    }
+}
+
+void thread_per_core()
+{
+    std::cout << "example 12: Thread-Per-Core Executor" << std::endl;
+
+    // Each core owns the counts for the words that hash to it, nothing is shared
+    using WordCounts = std::unordered_map<std::string, int>;
+    ShardedExecutor<WordCounts> executor(4);
+    const size_t cores = executor.cores();
+
+    const char* text[] = {"the", "quick", "brown", "fox", "jumps", "over", "the", "lazy", "dog", "the", "end"};
+
+    // Core 0 reads the text and forwards each word to its owner over the mailboxes
+    executor.submit_to(0, [&executor, &text, cores](WordCounts&)
+    {
+        for (int round = 0; round < 100; ++round)
+        {
+            for (const char* word : text)
+            {
+                size_t owner = std::hash<std::string>()(word) % cores;
+                executor.submit_to(owner, [word](WordCounts& counts) { counts[word]++; });
+            }
+        }
+    });
+    executor.wait_idle();
+
+    size_t distinct = executor.map_reduce_across_cores([](WordCounts& counts) { return counts.size(); },
+                                                       size_t{0}, [](size_t a, size_t b) { return a + b; });
+    int the = executor.map_reduce_across_cores([](WordCounts& counts)
+    {
+        auto it = counts.find("the");
+        return it == counts.end() ? 0 : it->second;
+    }, 0, [](int a, int b) { return a + b; });
+
+    std::cout << "Distinct words across " << cores << " cores: " << distinct << std::endl;
+    std::cout << "\"the\" seen (should be 300): " << the << std::endl;
+}
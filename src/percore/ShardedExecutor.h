@@ -0,0 +1,536 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef SHARDEDEXECUTOR_H
+#define SHARDEDEXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Pool.h"
+#include "SchedPoint.h"
+
+namespace percore_detail
+{
+    // The executor and core the calling thread reacts for, if any
+    struct CurrentCore
+    {
+        const void* executor = nullptr;
+        size_t index = 0;
+    };
+
+    extern thread_local CurrentCore current;
+
+    // CPUs in this process's affinity mask, in order
+    std::vector<int> allowed_cpus();
+    bool pin_current_thread(int cpu);
+
+    // Private futex on a reactor's sleeping word
+    void park(std::atomic<uint32_t>& word, uint32_t expected);
+    void wake(std::atomic<uint32_t>& word);
+
+    /**
+     * Counts down once per core for map_reduce_across_cores, the waiter
+     * sleeps on a futex until it reaches zero
+     */
+    class Latch
+    {
+    public:
+        explicit Latch(uint32_t count);
+
+        void count_down();
+        void wait();
+
+    private:
+        std::atomic<uint32_t> remaining_;
+    };
+
+    /**
+     * Bounded single-producer single-consumer ring. Each side caches the
+     * other's index and only reloads it when the ring looks full or empty,
+     * so in steady state a push or pop touches just its own cache line.
+     */
+    template <typename T>
+    class SpscRing
+    {
+    public:
+        explicit SpscRing(size_t capacity) : mask_(round_pow2(capacity) - 1), slots_(new T[mask_ + 1])
+        {
+        }
+
+        // Producer only; item is left untouched when the ring is full
+        bool try_push(T& item)
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_cache_ > mask_)
+            {
+                head_cache_ = head_.load(std::memory_order_acquire);
+                if (tail - head_cache_ > mask_)
+                {
+                    return false;
+                }
+            }
+            slots_[tail & mask_] = std::move(item);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only
+        bool try_pop(T& item)
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_cache_)
+            {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head == tail_cache_)
+                {
+                    return false;
+                }
+            }
+            item = std::move(slots_[head & mask_]);
+            slots_[head & mask_] = T();
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only
+        bool empty() const
+        {
+            return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+        }
+
+    private:
+        static size_t round_pow2(size_t n)
+        {
+            size_t p = 1;
+            while (p < n)
+            {
+                p <<= 1;
+            }
+            return p;
+        }
+
+        const size_t mask_;
+        std::unique_ptr<T[]> slots_;
+        alignas(64) std::atomic<size_t> tail_{0};
+        size_t head_cache_ = 0; // producer's view of head_
+        alignas(64) std::atomic<size_t> head_{0};
+        size_t tail_cache_ = 0; // consumer's view of tail_
+    };
+}
+
+/**
+ * How the reactors run. An idle reactor spins, then yields, then sleeps on a
+ * futex until a message arrives; spinning only pays with a core to spare.
+ */
+struct ReactorOptions
+{
+    // Pin reactor i to the i-th CPU of the affinity mask
+    bool pin_threads = true;
+    // Messages in flight from one core to another before the sender buffers them
+    size_t mailbox_capacity = 256;
+    unsigned spin_rounds = 1000;
+    unsigned yield_rounds = 64;
+};
+
+/**
+ * Thread-per-core, shard-nothing executor: the alternative to ThreadPool for
+ * latency-sensitive work. Every core runs one reactor thread that owns a
+ * Shard, constructed on that thread, and only that thread ever touches it.
+ * There is no shared queue: core i reaches core j through its own SPSC
+ * mailbox, so the only cache lines crossing cores are the messages.
+ *
+ * submit_to(core, fn) runs fn(shard) on that core. From a reactor it goes
+ * through the pair's mailbox, overflowing into a buffer the sender drains
+ * when the mailbox is full, so two busy cores never block on each other.
+ * From other threads it goes through the core's locked inbox.
+ */
+template <typename Shard>
+class ShardedExecutor
+{
+public:
+    using Task = std::function<void(Shard&)>;
+
+    static constexpr size_t kNoCore = static_cast<size_t>(-1);
+
+    // cores 0 uses one per CPU in the affinity mask
+    explicit ShardedExecutor(size_t cores = 0, const ReactorOptions& options = ReactorOptions())
+        : options_(options), cpus_(percore_detail::allowed_cpus())
+    {
+        const size_t count = cores != 0 ? cores : std::max<size_t>(1, cpus_.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            cores_.emplace_back(new Core(count));
+        }
+        mailboxes_.reserve(count * count);
+        for (size_t i = 0; i < count * count; ++i)
+        {
+            mailboxes_.emplace_back(new percore_detail::SpscRing<Task>(options_.mailbox_capacity));
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            cores_[i]->thread = std::thread(&ShardedExecutor::reactor, this, i);
+        }
+    }
+
+    // Runs everything already submitted, including what it submits in turn
+    ~ShardedExecutor()
+    {
+        wait_idle();
+        stop_.store(true, std::memory_order_seq_cst);
+        for (auto& core : cores_)
+        {
+            core->sleeping.store(0, std::memory_order_relaxed);
+            percore_detail::wake(core->sleeping);
+        }
+        for (auto& core : cores_)
+        {
+            core->thread.join();
+        }
+    }
+
+    ShardedExecutor(const ShardedExecutor&) = delete;
+    ShardedExecutor& operator=(const ShardedExecutor&) = delete;
+
+    size_t cores() const
+    {
+        return cores_.size();
+    }
+
+    // The reactor calling this, kNoCore on any other thread
+    size_t current_core() const
+    {
+        return percore_detail::current.executor == this ? percore_detail::current.index : kNoCore;
+    }
+
+    // Throws std::out_of_range unless core < cores(); nothing is queued then
+    template <typename F>
+    void submit_to(size_t core, F&& fn)
+    {
+        if (core >= cores_.size())
+        {
+            throw std::out_of_range("ShardedExecutor::submit_to: core " + std::to_string(core) + " of "
+                                    + std::to_string(cores_.size()));
+        }
+        THREADING_SCHED_POINT();
+        Task task(std::forward<F>(fn));
+        const size_t from = current_core();
+        if (from != kNoCore)
+        {
+            send(from, core, task);
+            return;
+        }
+
+        // Counted before it can run, so wait_idle() never sees it finish unsent
+        external_sent_.fetch_add(1, std::memory_order_release);
+        Core& to = *cores_[core];
+        {
+            std::lock_guard<std::mutex> lock(to.inbox_mtx);
+            to.inbox.push_back(std::move(task));
+            to.inbox_pending.store(true, std::memory_order_release);
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        notify(to);
+    }
+
+    /**
+     * Run map(shard) on every core and fold the results in core order with
+     * reduce(acc, partial), starting from init. Blocks the caller, so call it
+     * from outside the reactors; messages map sends on are not waited for.
+     */
+    template <typename Map, typename R, typename Reduce>
+    R map_reduce_across_cores(Map map, R init, Reduce reduce)
+    {
+        // One line per core, and never vector<bool>'s shared words
+        struct alignas(64) Partial
+        {
+            R value;
+        };
+        std::vector<Partial> partial(cores_.size(), Partial{init});
+        percore_detail::Latch latch(static_cast<uint32_t>(cores_.size()));
+        for (size_t i = 0; i < cores_.size(); ++i)
+        {
+            submit_to(i, [&map, &partial, &latch, i](Shard& shard)
+            {
+                partial[i].value = map(shard);
+                latch.count_down();
+            });
+        }
+        latch.wait();
+        for (auto& p : partial)
+        {
+            init = reduce(std::move(init), std::move(p.value));
+        }
+        return init;
+    }
+
+    /**
+     * Block until every submitted task and everything it submitted has run.
+     * Each core counts what it sent and completed on its own cache line; the
+     * executor is idle once the totals agree twice in a row, read in the
+     * order completed, sent, completed, sent (Mattern's four counters).
+     * Nothing may be submitted from outside meanwhile.
+     */
+    void wait_idle()
+    {
+        while (true)
+        {
+            const uint64_t completed = total_completed();
+            if (completed == total_sent() && completed == total_completed() && completed == total_sent())
+            {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+private:
+    struct alignas(64) Core
+    {
+        explicit Core(size_t cores) : overflow(cores)
+        {
+        }
+
+        std::thread thread;
+        std::unique_ptr<Shard> shard;
+
+        // Owned by the reactor: messages its mailboxes had no room for, and
+        // cores it sent to since it last checked whether they sleep
+        std::vector<std::deque<Task>> overflow;
+        size_t overflowing = 0;
+        std::vector<size_t> touched;
+
+        // Written only by the reactor, read by wait_idle()
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> completed{0};
+
+        // 1 while the reactor is asleep or about to be; the futex word
+        alignas(64) std::atomic<uint32_t> sleeping{0};
+
+        std::mutex inbox_mtx;
+        std::vector<Task> inbox;
+        std::atomic<bool> inbox_pending{false};
+    };
+
+    // Deliveries to one core per poll before moving on to the next sender
+    static constexpr size_t kBatch = 64;
+
+    percore_detail::SpscRing<Task>& mailbox(size_t from, size_t to)
+    {
+        return *mailboxes_[from * cores_.size() + to];
+    }
+
+    static void bump(std::atomic<uint64_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint64_t total_sent() const
+    {
+        uint64_t total = external_sent_.load(std::memory_order_acquire);
+        for (const auto& core : cores_)
+        {
+            total += core->sent.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    uint64_t total_completed() const
+    {
+        uint64_t total = 0;
+        for (const auto& core : cores_)
+        {
+            total += core->completed.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    // From reactor from; keeps per-destination order by never skipping ahead of the overflow
+    void send(size_t from, size_t to, Task& task)
+    {
+        Core& me = *cores_[from];
+        bump(me.sent);
+        std::deque<Task>& backlog = me.overflow[to];
+        if (!backlog.empty() || !mailbox(from, to).try_push(task))
+        {
+            me.overflowing += backlog.empty();
+            backlog.push_back(std::move(task));
+            return;
+        }
+        if (me.touched.empty() || me.touched.back() != to)
+        {
+            me.touched.push_back(to);
+        }
+    }
+
+    // After a fence: wake the core if it went to sleep without seeing the message
+    void notify(Core& core)
+    {
+        if (core.sleeping.load(std::memory_order_relaxed) != 0 && core.sleeping.exchange(0) != 0)
+        {
+            percore_detail::wake(core.sleeping);
+        }
+    }
+
+    void flush_overflow(size_t index)
+    {
+        Core& me = *cores_[index];
+        for (size_t to = 0; me.overflowing != 0 && to < cores_.size(); ++to)
+        {
+            std::deque<Task>& backlog = me.overflow[to];
+            if (backlog.empty())
+            {
+                continue;
+            }
+            while (!backlog.empty() && mailbox(index, to).try_push(backlog.front()))
+            {
+                backlog.pop_front();
+                me.touched.push_back(to);
+            }
+            me.overflowing -= backlog.empty();
+        }
+    }
+
+    void notify_touched(Core& me)
+    {
+        if (me.touched.empty())
+        {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (size_t to : me.touched)
+        {
+            notify(*cores_[to]);
+        }
+        me.touched.clear();
+    }
+
+    void run(Core& me, Task& task)
+    {
+        task(*me.shard);
+        bump(me.completed);
+    }
+
+    // One round over the inbox and every incoming mailbox, returns how many tasks ran
+    size_t poll(size_t index)
+    {
+        Core& me = *cores_[index];
+        size_t ran = 0;
+        if (me.inbox_pending.load(std::memory_order_acquire))
+        {
+            std::vector<Task> batch;
+            {
+                std::lock_guard<std::mutex> lock(me.inbox_mtx);
+                batch.swap(me.inbox);
+                me.inbox_pending.store(false, std::memory_order_relaxed);
+            }
+            for (auto& task : batch)
+            {
+                run(me, task);
+            }
+            ran += batch.size();
+        }
+
+        Task task;
+        for (size_t from = 0; from < cores_.size(); ++from)
+        {
+            percore_detail::SpscRing<Task>& incoming = mailbox(from, index);
+            for (size_t n = 0; n < kBatch && incoming.try_pop(task); ++n)
+            {
+                run(me, task);
+                ran++;
+            }
+        }
+        flush_overflow(index);
+        notify_touched(me);
+        return ran;
+    }
+
+    bool has_work(size_t index)
+    {
+        Core& me = *cores_[index];
+        if (me.inbox_pending.load(std::memory_order_acquire))
+        {
+            return true;
+        }
+        for (size_t from = 0; from < cores_.size(); ++from)
+        {
+            if (!mailbox(from, index).empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void reactor(size_t index)
+    {
+        if (options_.pin_threads && !cpus_.empty())
+        {
+            percore_detail::pin_current_thread(cpus_[index % cpus_.size()]);
+        }
+        percore_detail::current = percore_detail::CurrentCore{this, index};
+        Core& me = *cores_[index];
+        // First touch from the owning core keeps the shard in its local memory
+        me.shard.reset(new Shard());
+
+        unsigned idle = 0;
+        while (!stop_.load(std::memory_order_acquire))
+        {
+            THREADING_SCHED_POINT();
+            if (poll(index) != 0)
+            {
+                idle = 0;
+                continue;
+            }
+            idle++;
+            if (idle <= options_.spin_rounds)
+            {
+                cpu_relax();
+            }
+            else if (idle <= options_.spin_rounds + options_.yield_rounds || me.overflowing != 0)
+            {
+                // A backlog drains only by polling, keep at it
+                std::this_thread::yield();
+            }
+            else
+            {
+                // Pairs with the fence in submit_to() and notify_touched()
+                me.sleeping.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!has_work(index) && !stop_.load(std::memory_order_relaxed))
+                {
+                    percore_detail::park(me.sleeping, 1);
+                }
+                me.sleeping.store(0, std::memory_order_relaxed);
+                idle = 0;
+            }
+        }
+        me.shard.reset();
+        percore_detail::current = percore_detail::CurrentCore{};
+    }
+
+    const ReactorOptions options_;
+    const std::vector<int> cpus_;
+    std::vector<std::unique_ptr<Core>> cores_;
+    std::vector<std::unique_ptr<percore_detail::SpscRing<Task>>> mailboxes_;
+    std::atomic<bool> stop_{false};
+    alignas(64) std::atomic<uint64_t> external_sent_{0};
+};
+
+void thread_per_core();
+
+#endif // SHARDEDEXECUTOR_H
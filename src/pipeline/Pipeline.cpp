@@ -0,0 +1,110 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Pipeline.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+    struct Record
+    {
+        int key;
+        long long value;
+    };
+
+    /**
+     * parse -> transform -> aggregate -> sink over synthetic "key,value" lines,
+     * returns items per second
+     */
+    double run_ingest(ThreadPool& pool, const std::vector<std::string>& lines, size_t parallelism,
+                      size_t batch, long long& checksum)
+    {
+        std::unordered_map<int, long long> totals;
+        long long sunk = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            auto ingest = make_pipeline<std::string>(pool)
+                .stage(StageOptions::parallel("parse", parallelism, batch), [](std::string line)
+                {
+                    size_t comma = line.find(',');
+                    return Record{std::stoi(line.substr(0, comma)), std::stoll(line.substr(comma + 1))};
+                })
+                .stage(StageOptions::parallel("transform", parallelism, batch), [](Record r) -> std::optional<Record>
+                {
+                    // Drop odd keys, then do a little arithmetic on the rest
+                    if (r.key % 2 != 0)
+                    {
+                        return std::nullopt;
+                    }
+                    for (int i = 0; i < 50; ++i)
+                    {
+                        r.value = (r.value * 31 + i) % 1000003;
+                    }
+                    return r;
+                })
+                .stage(StageOptions::serial_in_order("aggregate", batch), [&totals](Record r)
+                {
+                    totals[r.key] += r.value;
+                    return std::make_pair(r.key, totals[r.key]);
+                })
+                .sink(StageOptions::parallel("sink", 1, batch), [&sunk](std::pair<int, long long> running)
+                {
+                    sunk += running.second % 7;
+                });
+
+            for (const auto& line : lines)
+            {
+                ingest.push(line);
+            }
+            ingest.wait();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        checksum = sunk;
+        return lines.size() / elapsed;
+    }
+}
+
+void pipeline(size_t threads, const PoolOptions& options)
+{
+    std::cout << "example 5: Multi-Stage Pipeline" << std::endl;
+
+    const size_t num_items = 200000;
+    std::vector<std::string> lines;
+    lines.reserve(num_items);
+    for (size_t i = 0; i < num_items; ++i)
+    {
+        lines.push_back(std::to_string(i % 97) + "," + std::to_string(i * 7919 % 100003));
+    }
+
+    ThreadPool pool(threads, options);
+    // Compare a serial stage with a parallel one even on a single worker
+    const size_t workers = std::max<size_t>(2, threads);
+
+    std::cout << std::left << std::setw(14) << "parallelism"
+        << std::setw(10) << "batch"
+        << std::right << std::setw(16) << "items/sec"
+        << std::setw(12) << "checksum" << std::endl;
+
+    for (size_t batch : {1, 16, 128})
+    {
+        for (size_t parallelism : {size_t(1), workers})
+        {
+            long long checksum = 0;
+            double rate = run_ingest(pool, lines, parallelism, batch, checksum);
+            std::cout << std::left << std::setw(14) << parallelism
+                << std::setw(10) << batch
+                << std::right << std::setw(16) << std::fixed << std::setprecision(0) << rate
+                << std::setw(12) << checksum << std::endl;
+        }
+    }
+}
@@ -0,0 +1,516 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Pool.h"
+
+/**
+ * How a single pipeline stage runs.
+ * capacity bounds the stage's input queue, batch is how many items one pool task takes at once.
+ */
+struct StageOptions
+{
+    std::string name;
+    size_t parallelism = 1;
+    size_t batch = 32;
+    size_t capacity = 1024;
+    bool in_order = false;
+
+    static StageOptions parallel(std::string name, size_t parallelism, size_t batch = 32)
+    {
+        StageOptions options;
+        options.name = std::move(name);
+        options.parallelism = parallelism;
+        options.batch = batch;
+        return options;
+    }
+
+    static StageOptions serial_in_order(std::string name, size_t batch = 32)
+    {
+        StageOptions options;
+        options.name = std::move(name);
+        options.batch = batch;
+        options.in_order = true;
+        return options;
+    }
+};
+
+namespace pipeline_detail
+{
+    /**
+     * An item travelling through the pipeline. Items removed by a filtering
+     * stage keep travelling empty so in-order stages never wait on a gap.
+     */
+    template <typename T>
+    struct Slot
+    {
+        uint64_t seq;
+        std::optional<T> value;
+    };
+
+    template <typename T>
+    struct unwrap_optional
+    {
+        using type = T;
+    };
+
+    template <typename T>
+    struct unwrap_optional<std::optional<T>>
+    {
+        using type = T;
+    };
+
+    struct StageBase
+    {
+        virtual ~StageBase() = default;
+        virtual void schedule() = 0;
+
+        StageBase* upstream = nullptr;
+    };
+
+    /**
+     * Shared bookkeeping: which pool runs the stages and when everything pushed has drained
+     */
+    class PipelineCore
+    {
+    public:
+        explicit PipelineCore(ThreadPool& pool) : pool_(pool)
+        {
+        }
+
+        template <typename F>
+        void launch(F&& task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                outstanding_++;
+            }
+            pool_.enqueue([this, task = std::forward<F>(task)]() mutable
+            {
+                task();
+                std::lock_guard<std::mutex> lock(mtx_);
+                outstanding_--;
+                done_cv_.notify_all();
+            });
+        }
+
+        /**
+         * Admit one more item, blocking while the pipeline already holds max_in_flight
+         */
+        void item_pushed()
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            room_cv_.wait(lock, [this] { return pushed_ - finished_ < max_in_flight; });
+            pushed_++;
+        }
+
+        void items_finished(size_t count)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                finished_ += count;
+            }
+            room_cv_.notify_all();
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            done_cv_.wait(lock, [this] { return finished_ == pushed_ && outstanding_ == 0; });
+        }
+
+        std::vector<std::unique_ptr<StageBase>> stages;
+        size_t max_in_flight = 0;
+
+    private:
+        ThreadPool& pool_;
+        std::mutex mtx_;
+        std::condition_variable done_cv_;
+        std::condition_variable room_cv_;
+        uint64_t pushed_ = 0;
+        uint64_t finished_ = 0;
+        int outstanding_ = 0;
+    };
+
+    /**
+     * A stage consuming T. Its input queue is bounded: upstream stages reserve
+     * room before they take a batch, so a full stage stalls everything behind it
+     * without ever blocking a pool worker.
+     */
+    template <typename T>
+    class Stage : public StageBase
+    {
+    public:
+        using Batch = std::vector<Slot<T>>;
+
+        Stage(PipelineCore& core, const StageOptions& options)
+            : core_(core), options_(options)
+        {
+            options_.parallelism = options_.in_order ? 1 : std::max<size_t>(1, options_.parallelism);
+            options_.batch = std::max<size_t>(1, options_.batch);
+            options_.capacity = std::max(options_.capacity, options_.batch);
+        }
+
+        void connect(StageBase* downstream, std::function<size_t(size_t)> reserve,
+                     std::function<void(Batch&)> process)
+        {
+            downstream_ = downstream;
+            reserve_downstream_ = std::move(reserve);
+            process_ = std::move(process);
+        }
+
+        /**
+         * Claim up to n input slots for an upstream batch, returns how many were granted.
+         * An in-order stage never refuses: out-of-order arrivals could otherwise fill it
+         * while the item it waits for is stuck behind them. Its size is bounded by the
+         * pipeline-wide in-flight limit instead.
+         */
+        size_t reserve(size_t n)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            size_t used = queued() + reserved_;
+            size_t granted = n;
+            if (!options_.in_order)
+            {
+                granted = used >= options_.capacity ? 0 : std::min(n, options_.capacity - used);
+            }
+            reserved_ += granted;
+            return granted;
+        }
+
+        size_t capacity() const
+        {
+            return options_.capacity;
+        }
+
+        /**
+         * Hand over a batch whose room was reserved earlier
+         */
+        template <typename Out>
+        void deliver(std::vector<Slot<Out>>& batch)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                for (auto& slot : batch)
+                {
+                    insert(std::move(slot));
+                }
+                reserved_ -= batch.size();
+            }
+            schedule();
+        }
+
+        /**
+         * Entry point for the head stage, blocks the caller while the stage is full
+         */
+        void push(T item)
+        {
+            core_.item_pushed();
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                room_cv_.wait(lock, [this] { return queued() + reserved_ < options_.capacity; });
+                insert(Slot<T>{next_push_seq_++, std::move(item)});
+            }
+            schedule();
+        }
+
+        void schedule() override
+        {
+            std::vector<Batch> launched;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                while (active_ < options_.parallelism)
+                {
+                    size_t n = std::min(options_.batch, ready());
+                    if (n == 0)
+                    {
+                        break;
+                    }
+                    if (downstream_)
+                    {
+                        n = reserve_downstream_(n);
+                        if (n == 0)
+                        {
+                            break;
+                        }
+                    }
+                    launched.push_back(take(n));
+                    active_++;
+                }
+            }
+            if (launched.empty())
+            {
+                return;
+            }
+
+            // Taking items freed room, let whoever feeds us continue
+            if (upstream)
+            {
+                upstream->schedule();
+            }
+            else
+            {
+                room_cv_.notify_all();
+            }
+
+            for (auto& batch : launched)
+            {
+                core_.launch([this, batch = std::move(batch)]() mutable
+                {
+                    process_(batch);
+                    {
+                        std::lock_guard<std::mutex> lock(mtx_);
+                        active_--;
+                    }
+                    schedule();
+                });
+            }
+        }
+
+    private:
+        size_t queued() const
+        {
+            return options_.in_order ? pending_.size() : fifo_.size();
+        }
+
+        void insert(Slot<T>&& slot)
+        {
+            if (options_.in_order)
+            {
+                uint64_t seq = slot.seq;
+                pending_.emplace(seq, std::move(slot));
+            }
+            else
+            {
+                fifo_.push_back(std::move(slot));
+            }
+        }
+
+        // Items that may be taken now: everything for unordered stages, the next
+        // run of consecutive sequence numbers for in-order ones
+        size_t ready() const
+        {
+            if (!options_.in_order)
+            {
+                return fifo_.size();
+            }
+            size_t count = 0;
+            uint64_t expect = next_seq_;
+            for (auto it = pending_.begin(); it != pending_.end() && it->first == expect; ++it, ++expect)
+            {
+                if (++count == options_.batch)
+                {
+                    break;
+                }
+            }
+            return count;
+        }
+
+        Batch take(size_t n)
+        {
+            Batch batch;
+            batch.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (options_.in_order)
+                {
+                    auto it = pending_.begin();
+                    batch.push_back(std::move(it->second));
+                    pending_.erase(it);
+                    next_seq_++;
+                }
+                else
+                {
+                    batch.push_back(std::move(fifo_.front()));
+                    fifo_.pop_front();
+                }
+            }
+            return batch;
+        }
+
+        PipelineCore& core_;
+        StageOptions options_;
+        StageBase* downstream_ = nullptr;
+        std::function<size_t(size_t)> reserve_downstream_;
+        std::function<void(Batch&)> process_;
+
+        std::mutex mtx_;
+        std::condition_variable room_cv_;
+        std::deque<Slot<T>> fifo_;
+        std::map<uint64_t, Slot<T>> pending_;
+        uint64_t next_seq_ = 0;
+        uint64_t next_push_seq_ = 0;
+        size_t reserved_ = 0;
+        size_t active_ = 0;
+    };
+}
+
+/**
+ * A finished pipeline: push items in, wait() until they have all reached the sink
+ */
+template <typename In>
+class Pipeline
+{
+public:
+    Pipeline(std::shared_ptr<pipeline_detail::PipelineCore> core, pipeline_detail::Stage<In>* head)
+        : core_(std::move(core)), head_(head)
+    {
+    }
+
+    Pipeline(Pipeline&&) noexcept = default;
+
+    ~Pipeline()
+    {
+        if (core_)
+        {
+            core_->wait();
+        }
+    }
+
+    void push(In item)
+    {
+        head_->push(std::move(item));
+    }
+
+    void wait()
+    {
+        core_->wait();
+    }
+
+private:
+    std::shared_ptr<pipeline_detail::PipelineCore> core_;
+    pipeline_detail::Stage<In>* head_;
+};
+
+/**
+ * Builds a pipeline one stage at a time. Cur is the item type the next stage will receive.
+ */
+template <typename In, typename Cur>
+class PipelineBuilder
+{
+public:
+    using Connect = std::function<void(pipeline_detail::Stage<Cur>*)>;
+
+    PipelineBuilder(std::shared_ptr<pipeline_detail::PipelineCore> core,
+                    pipeline_detail::Stage<In>* head, Connect connect)
+        : core_(std::move(core)), head_(head), connect_(std::move(connect))
+    {
+    }
+
+    /**
+     * Add a transforming stage. fn maps Cur to the next item type; returning a
+     * std::optional lets the stage filter items out.
+     */
+    template <typename F>
+    auto stage(const StageOptions& options, F fn)
+    {
+        using Result = std::invoke_result_t<F&, Cur>;
+        using Next = typename pipeline_detail::unwrap_optional<Result>::type;
+        using namespace pipeline_detail;
+
+        Stage<Cur>* stage = add_stage(options);
+        auto connect = [stage, fn](Stage<Next>* next) mutable
+        {
+            next->upstream = stage;
+            stage->connect(next,
+                           [next](size_t n) { return next->reserve(n); },
+                           [fn, next](std::vector<Slot<Cur>>& batch) mutable
+                           {
+                               std::vector<Slot<Next>> out;
+                               out.reserve(batch.size());
+                               for (auto& slot : batch)
+                               {
+                                   if (slot.value)
+                                   {
+                                       out.push_back(Slot<Next>{slot.seq, fn(std::move(*slot.value))});
+                                   }
+                                   else
+                                   {
+                                       out.push_back(Slot<Next>{slot.seq, std::nullopt});
+                                   }
+                               }
+                               next->deliver(out);
+                           });
+        };
+        return PipelineBuilder<In, Next>(core_, head_, std::move(connect));
+    }
+
+    /**
+     * Finish the pipeline with a stage that consumes every item
+     */
+    template <typename F>
+    Pipeline<In> sink(const StageOptions& options, F fn)
+    {
+        using namespace pipeline_detail;
+
+        Stage<Cur>* stage = add_stage(options);
+        PipelineCore* core = core_.get();
+        stage->connect(nullptr, nullptr, [fn, core](std::vector<Slot<Cur>>& batch) mutable
+        {
+            for (auto& slot : batch)
+            {
+                if (slot.value)
+                {
+                    fn(std::move(*slot.value));
+                }
+            }
+            core->items_finished(batch.size());
+        });
+        return Pipeline<In>(core_, head_);
+    }
+
+private:
+    pipeline_detail::Stage<Cur>* add_stage(const StageOptions& options)
+    {
+        auto stage = std::make_unique<pipeline_detail::Stage<Cur>>(*core_, options);
+        auto* raw = stage.get();
+        core_->stages.push_back(std::move(stage));
+        core_->max_in_flight += raw->capacity();
+        if constexpr (std::is_same_v<Cur, In>)
+        {
+            if (!head_)
+            {
+                head_ = raw;
+            }
+        }
+        connect_(raw);
+        return raw;
+    }
+
+    std::shared_ptr<pipeline_detail::PipelineCore> core_;
+    pipeline_detail::Stage<In>* head_;
+    Connect connect_;
+};
+
+/**
+ * Start a pipeline whose stages run as tasks on pool. Stages never block a
+ * worker, but the pool should be unbounded (or use CallerRuns) so stage tasks
+ * are never rejected.
+ */
+template <typename In>
+PipelineBuilder<In, In> make_pipeline(ThreadPool& pool)
+{
+    auto core = std::make_shared<pipeline_detail::PipelineCore>(pool);
+    return PipelineBuilder<In, In>(core, nullptr, [](pipeline_detail::Stage<In>*) {});
+}
+
+void pipeline(size_t threads, const PoolOptions& options);
+
+#endif // PIPELINE_H
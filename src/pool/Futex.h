@@ -0,0 +1,31 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Process-private futex on an atomic word; include from .cpp files only
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit int");
+
+// Sleeps only while word still equals expected; timeout nullptr waits indefinitely
+inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, const timespec* timeout = nullptr)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+}
+
+inline void futex_wake_all(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#endif // FUTEX_H
@@ -0,0 +1,129 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef INPLACE_TASK_H
+#define INPLACE_TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * A move-only void() callable that keeps targets of up to Bytes inline, so
+ * queuing a small closure never touches the heap; larger ones are boxed.
+ * Unlike std::function the target does not have to be copyable.
+ */
+template <size_t Bytes = 48>
+class InplaceTask
+{
+public:
+    InplaceTask() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceTask>>>
+    InplaceTask(F&& fn)
+    {
+        using Target = std::decay_t<F>;
+        if constexpr (fits_inline<Target>())
+        {
+            new (storage_) Target(std::forward<F>(fn));
+            ops_ = &kInlineOps<Target>;
+        }
+        else
+        {
+            new (storage_) Target*(new Target(std::forward<F>(fn)));
+            ops_ = &kBoxedOps<Target>;
+        }
+    }
+
+    InplaceTask(InplaceTask&& other) noexcept
+    {
+        take(other);
+    }
+
+    InplaceTask& operator=(InplaceTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    InplaceTask(const InplaceTask&) = delete;
+    InplaceTask& operator=(const InplaceTask&) = delete;
+
+    ~InplaceTask()
+    {
+        reset();
+    }
+
+    explicit operator bool() const
+    {
+        return ops_ != nullptr;
+    }
+
+    void operator()()
+    {
+        ops_->invoke(storage_);
+    }
+
+private:
+    struct Ops
+    {
+        void (*invoke)(void* storage);
+        // Move-construct into to and destroy what is left in from
+        void (*relocate)(void* to, void* from);
+        void (*destroy)(void* storage);
+    };
+
+    // Moving a queued task must not throw, or a full queue could lose it
+    template <typename T>
+    static constexpr bool fits_inline()
+    {
+        return sizeof(T) <= Bytes && alignof(T) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<T>;
+    }
+
+    template <typename T>
+    static constexpr Ops kInlineOps{
+        [](void* storage) { (*static_cast<T*>(storage))(); },
+        [](void* to, void* from)
+        {
+            new (to) T(std::move(*static_cast<T*>(from)));
+            static_cast<T*>(from)->~T();
+        },
+        [](void* storage) { static_cast<T*>(storage)->~T(); },
+    };
+
+    template <typename T>
+    static constexpr Ops kBoxedOps{
+        [](void* storage) { (**static_cast<T**>(storage))(); },
+        [](void* to, void* from) { new (to) T*(*static_cast<T**>(from)); },
+        [](void* storage) { delete *static_cast<T**>(storage); },
+    };
+
+    void take(InplaceTask& other) noexcept
+    {
+        ops_ = std::exchange(other.ops_, nullptr);
+        if (ops_)
+        {
+            ops_->relocate(storage_, other.storage_);
+        }
+    }
+
+    void reset()
+    {
+        if (ops_)
+        {
+            std::exchange(ops_, nullptr)->destroy(storage_);
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[Bytes < sizeof(void*) ? sizeof(void*) : Bytes];
+    const Ops* ops_ = nullptr;
+};
+
+#endif // INPLACE_TASK_H
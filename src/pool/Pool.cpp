@@ -3,101 +3,139 @@
 //
 
 #include "Pool.h"
+#include "TaskGroup.h"
 
 #include <ostream>
 #include <iostream>
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <condition_variable>
 #include <functional>
+#include <iomanip>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
+#include <time.h>
 
-ThreadPool::ThreadPool(size_t num_threads)
-    : stop_(false), active_task_(0), completed_task_(0)
+namespace
 {
-    for (size_t i = 0; i < num_threads; ++i)
+    void update_max(std::atomic<uint64_t>& max, uint64_t value)
     {
-        workers_.emplace_back([this, i]
+        uint64_t seen = max.load(std::memory_order_relaxed);
+        while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed))
         {
-            worker_thread(i);
-        });
+        }
     }
-    std::cout << "Thread pool created with " << num_threads << " workers" << std::endl;
 }
 
-ThreadPool::~ThreadPool()
+void TaskStats::record(std::chrono::nanoseconds wait, std::chrono::nanoseconds run)
 {
-    {
-        std::unique_lock<std::mutex> lock(queue_mtx_);
-        stop_ = true;
-    }
-
-    cv_.notify_all();
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    wait_ns_.fetch_add(wait.count(), std::memory_order_relaxed);
+    run_ns_.fetch_add(run.count(), std::memory_order_relaxed);
+    update_max(max_wait_ns_, wait.count());
+    update_max(max_run_ns_, run.count());
+}
 
-    for (auto& worker : workers_)
+void TaskStats::record_owned(std::chrono::nanoseconds wait, std::chrono::nanoseconds run)
+{
+    auto add = [](std::atomic<uint64_t>& total, uint64_t value)
+    {
+        total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    };
+    auto keep_max = [](std::atomic<uint64_t>& max, uint64_t value)
     {
-        if (worker.joinable())
+        if (value > max.load(std::memory_order_relaxed))
         {
-            worker.join();
+            max.store(value, std::memory_order_relaxed);
         }
-    }
+    };
+    add(completed_, 1);
+    add(wait_ns_, wait.count());
+    add(run_ns_, run.count());
+    keep_max(max_wait_ns_, wait.count());
+    keep_max(max_run_ns_, run.count());
+}
 
-    std::cout << "Thread pool destroyed" << std::endl;
+void TaskStats::record_blocked()
+{
+    blocked_.fetch_add(1, std::memory_order_relaxed);
 }
 
-int ThreadPool::get_active_tasks() const
+PoolStats TaskStats::combine(const std::vector<const TaskStats*>& parts, size_t threads, size_t queued)
 {
-    return active_task_;
+    PoolStats stats;
+    stats.threads = threads;
+    stats.queued = queued;
+
+    uint64_t wait_ns = 0;
+    uint64_t run_ns = 0;
+    for (const TaskStats* part : parts)
+    {
+        stats.completed += part->completed_.load();
+        wait_ns += part->wait_ns_.load();
+        run_ns += part->run_ns_.load();
+        stats.max_wait_us = std::max(stats.max_wait_us, part->max_wait_ns_.load() / 1000.0);
+        stats.max_run_us = std::max(stats.max_run_us, part->max_run_ns_.load() / 1000.0);
+        stats.blocked_tasks += part->blocked_.load();
+    }
+    if (stats.completed > 0)
+    {
+        stats.mean_wait_us = wait_ns / 1000.0 / stats.completed;
+        stats.mean_run_us = run_ns / 1000.0 / stats.completed;
+    }
+    return stats;
 }
 
-int ThreadPool::get_completed_tasks() const
+std::ostream& operator<<(std::ostream& out, const PoolStats& stats)
 {
-    return completed_task_;
+    return out << stats.threads << " threads, " << stats.queued << " queued, " << stats.completed << " done, wait "
+        << std::fixed << std::setprecision(1) << stats.mean_wait_us << "us avg / " << stats.max_wait_us
+        << "us max, run " << stats.mean_run_us << "us avg / " << stats.max_run_us << "us max, "
+        << stats.blocked_tasks << " blocked";
 }
 
-int ThreadPool::get_pending_tasks()
+namespace
 {
-    std::unique_lock<std::mutex> lock(queue_mtx_);
-    return tasks_.size();
+    std::mutex label_mtx;
+    std::atomic<const char*> label_names[TaskLabel::kMaxLabels] = {{"task"}};
+    uint16_t next_label = 1;
 }
 
-void ThreadPool::worker_thread(int id)
+TaskLabel::TaskLabel(const char* name)
+    : id_(0)
 {
-    std::cout << "Worker " << id << " started" << std::endl;
-    while (true)
+    std::lock_guard<std::mutex> lock(label_mtx);
+    for (uint16_t id = 1; id < next_label; ++id)
     {
-        std::function<void()> task;
+        if (std::strcmp(label_names[id].load(std::memory_order_relaxed), name) == 0)
         {
-            std::unique_lock<std::mutex> lock(queue_mtx_);
-            cv_.wait(lock, [this]
-            {
-                return stop_ || !tasks_.empty();
-            });
+            id_ = id;
+            return;
+        }
+    }
+    if (next_label < kMaxLabels)
+    {
+        id_ = next_label++;
+        label_names[id_].store(name, std::memory_order_release);
+    }
+}
 
-            // Exit if we're stopping and no tasks remain
-            if (stop_ && tasks_.empty())
-            {
-                break;
-            }
+const char* TaskLabel::name_of(uint16_t id)
+{
+    const char* name = id < kMaxLabels ? label_names[id].load(std::memory_order_acquire) : nullptr;
+    return name ? name : label_names[0].load(std::memory_order_relaxed);
+}
 
-            // Get next task
-            if (!tasks_.empty())
-            {
-                task = std::move(tasks_.front());
-                tasks_.pop();
-            }
-        }
-        if (task)
-        {
-            active_task_++;
-            task();
-            active_task_--;
-            completed_task_++;
-        }
+namespace pool_detail
+{
+    std::chrono::nanoseconds thread_cpu_time()
+    {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
     }
-    std::cout << "Worker " << id << " completed" << std::endl;
 }
 
 void request(int request_id)
@@ -125,18 +163,19 @@ void compute_task(int id, int value)
     std::cout << "Task: " << id << " result: " << result << std::endl;
 }
 
-void basic_usage()
+void basic_usage(size_t threads, const PoolOptions& options)
 {
     std::cout << "example 3: Tasks with Shared State" << std::endl;
-    ThreadPool pool(4);
+    ThreadPool pool(threads, options);
 
     std::mutex result_mtx;
     int total_sum = 0;
 
     // Submit tasks that update shared state
+    TaskGroup group(pool);
     for (int i = 1; i <= 20; ++i)
     {
-        pool.enqueue([i, &total_sum, &result_mtx]
+        group.run([i, &total_sum, &result_mtx]
         {
             int local_sum = 0;
             for (int j = 0; j < 100; ++j)
@@ -155,23 +194,21 @@ void basic_usage()
     }
 
     // Wait for all tasks
-    while (pool.get_completed_tasks() < 20)
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    group.wait();
 
     std::cout << std::endl << "Total sum from all tasks: " << total_sum << std::endl;
 }
 
-void dynamic_tasks()
+void dynamic_tasks(size_t threads, const PoolOptions& options)
 {
     std::cout << "example 2: Dynamic Task Submission" << std::endl;
-    ThreadPool pool(3);
+    ThreadPool pool(threads, options);
 
     // Submit different types of tasks
+    TaskGroup group(pool);
     for (int i = 1; i <= 5; ++i)
     {
-        pool.enqueue([i]
+        group.run([i]
         {
             compute_task(i, 100 + i);
         });
@@ -182,7 +219,7 @@ void dynamic_tasks()
 
     for (int i = 6; i <= 8; ++i)
     {
-        pool.enqueue([i]
+        group.run([i]
         {
             std::cout << "Late task " << i << " starting\n";
             std::this_thread::sleep_for(std::chrono::milliseconds(200));
@@ -191,25 +228,23 @@ void dynamic_tasks()
     }
 
     // Wait for completion
-    while (pool.get_completed_tasks() < 8)
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    group.wait();
 }
 
-void shared_state()
+void shared_state(size_t threads, const PoolOptions& options)
 {
     std::cout << "example 3: Tasks with Shared State" << std::endl;
 
-    ThreadPool pool(4);
+    ThreadPool pool(threads, options);
 
     std::mutex result_mtx;
     int total_sum = 0;
 
     // Submit tasks that update shared state
+    TaskGroup group(pool);
     for (int i = 1; i <= 20; ++i)
     {
-        pool.enqueue([i, &total_sum, &result_mtx]
+        group.run([i, &total_sum, &result_mtx]
         {
             int local_sum = 0;
             for (int j = 0; j < 100; ++j)
@@ -228,10 +263,140 @@ void shared_state()
     }
 
     // Wait for all tasks
-    while (pool.get_completed_tasks() < 20)
+    group.wait();
+
+    std::cout << std::endl << "Total sum from all tasks: " << total_sum << std::endl;
+
+    // The same sum without the lock: every worker adds into its own partial,
+    // and the partials are folded once the group is done
+    struct PartialSum;
+    for (int i = 1; i <= 20; ++i)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        group.run([&pool]
+        {
+            int local_sum = 0;
+            for (int j = 0; j < 100; ++j)
+            {
+                local_sum += j;
+            }
+            pool.worker_local<int, PartialSum>() += local_sum;
+        });
     }
+    group.wait();
 
-    std::cout << std::endl << "Total sum from all tasks: " << total_sum << std::endl;
+    int combined = 0;
+    pool.combine_worker_locals<int, PartialSum>([&combined](int& partial) { combined += partial; });
+    std::cout << "Total sum from worker-local partials: " << combined << std::endl;
+}
+
+
+/**
+ * Drive a pool at twice its service rate and report how deep the queue gets
+ * and how long tasks wait before starting, for each overflow strategy
+ */
+void overload()
+{
+    std::cout << "example 4: Backpressure under 2x Overload" << std::endl;
+
+    using Clock = ThreadPool::Clock;
+    const int workers = 2;
+    const auto service_time = std::chrono::microseconds(500);
+    const auto duration = std::chrono::seconds(1);
+    // Arrivals come twice as fast as the workers can drain them
+    const auto arrival_gap = service_time / (2 * workers);
+    const int num_tasks = static_cast<int>(duration / arrival_gap);
+
+    struct Scenario
+    {
+        const char* name;
+        PoolOptions options;
+    };
+
+    PoolOptions unbounded;
+    PoolOptions block;
+    block.capacity = 64;
+    PoolOptions drop_oldest = block;
+    drop_oldest.overflow = OverflowPolicy::DropOldest;
+    PoolOptions caller_runs = block;
+    caller_runs.overflow = OverflowPolicy::CallerRuns;
+    PoolOptions codel;
+    codel.codel_target = std::chrono::milliseconds(5);
+    codel.codel_interval = std::chrono::milliseconds(50);
+
+    const Scenario scenarios[] = {
+        {"unbounded", unbounded},
+        {"block(64)", block},
+        {"drop-oldest(64)", drop_oldest},
+        {"caller-runs(64)", caller_runs},
+        {"codel(5ms)", codel},
+    };
+
+    std::cout << std::left << std::setw(18) << "policy"
+        << std::right << std::setw(10) << "run"
+        << std::setw(10) << "shed"
+        << std::setw(12) << "max queue"
+        << std::setw(12) << "p50 (ms)"
+        << std::setw(12) << "p99 (ms)" << std::endl;
+
+    for (const auto& scenario : scenarios)
+    {
+        // Each task records how long it sat in the queue, -1 means it never ran
+        std::vector<std::atomic<long long>> waits(num_tasks);
+        for (auto& w : waits)
+        {
+            w = -1;
+        }
+
+        int max_queue = 0;
+        int dropped = 0;
+        int rejected = 0;
+        {
+            ThreadPool pool(workers, scenario.options);
+            const auto start = Clock::now();
+            for (int i = 0; i < num_tasks; ++i)
+            {
+                std::this_thread::sleep_until(start + i * arrival_gap);
+                const auto submitted = Clock::now();
+                pool.enqueue([&waits, i, submitted, service_time]
+                {
+                    const auto began = Clock::now();
+                    waits[i] = std::chrono::duration_cast<std::chrono::microseconds>(began - submitted).count();
+                    while (Clock::now() - began < service_time)
+                    {
+                        // busy work standing in for a real request
+                    }
+                });
+                max_queue = std::max(max_queue, pool.get_pending_tasks());
+            }
+            dropped = pool.get_dropped_tasks();
+            rejected = pool.get_rejected_tasks();
+        }
+
+        std::vector<long long> served;
+        for (auto& w : waits)
+        {
+            if (w >= 0)
+            {
+                served.push_back(w);
+            }
+        }
+        std::sort(served.begin(), served.end());
+        auto percentile = [&served](double p)
+        {
+            if (served.empty())
+            {
+                return 0.0;
+            }
+            size_t idx = static_cast<size_t>(p * (served.size() - 1));
+            return served[idx] / 1000.0;
+        };
+
+        std::cout << std::left << std::setw(18) << scenario.name
+            << std::right << std::setw(10) << served.size()
+            << std::setw(10) << dropped + rejected
+            << std::setw(12) << max_queue
+            << std::fixed << std::setprecision(2)
+            << std::setw(12) << percentile(0.50)
+            << std::setw(12) << percentile(0.99) << std::endl;
+    }
 }
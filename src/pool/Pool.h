@@ -5,53 +5,1156 @@
 #ifndef POOL_H
 #define POOL_H
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <iostream>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
+#include <ostream>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-class ThreadPool
+#include "InplaceTask.h"
+#include "SchedPoint.h"
+
+/**
+ * One iteration of a busy-wait loop: tells the core we are spinning so it
+ * can yield pipeline resources to an SMT sibling
+ */
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * What enqueue() does when the queue is already at capacity
+ */
+enum class OverflowPolicy
+{
+    Block,      // wait until a worker frees a slot
+    Reject,     // fail fast, the new task is not queued
+    DropOldest, // discard the task that has waited longest
+    CallerRuns  // run the task on the submitting thread
+};
+
+/**
+ * Queue limits and load shedding for a ThreadPool.
+ * capacity 0 keeps the queue unbounded, codel_target 0 disables admission control.
+ */
+struct PoolOptions
+{
+    size_t capacity = 0;
+    OverflowPolicy overflow = OverflowPolicy::Block;
+
+    // CoDel: once the queue has not drained for an interval, shed tasks older than target
+    std::chrono::microseconds codel_target{0};
+    std::chrono::microseconds codel_interval{100000};
+
+    // Tasks submitted from inside a running task stay with that worker (see
+    // ThreadPool::enqueue). Off by default: a buffered child only starts once
+    // its parent returns, so a parent that blocks on it (a condition variable,
+    // a flag) deadlocks. Joining through TaskGroup::wait() is safe, it runs them.
+    bool local_batching = false;
+
+    // Read the thread CPU clock around every task to count tasks that mostly
+    // sat blocked (PoolStats::blocked_tasks). Costs two syscalls per task.
+    bool track_blocking = false;
+
+    // cpu_relax() rounds an idle worker spends watching for work before it
+    // sleeps on the condition variable. 0 sleeps at once; only worth it with
+    // spare cores, see auto_tune().
+    unsigned spin_iterations = 0;
+
+    // Log pool and worker lifecycle to std::cout
+    bool verbose = true;
+};
+
+/**
+ * Point-in-time view of a pool's queue and task timings
+ */
+struct PoolStats
+{
+    size_t threads = 0;
+    size_t queued = 0;
+    uint64_t completed = 0;
+    double mean_wait_us = 0; // enqueue to start
+    double max_wait_us = 0;
+    double mean_run_us = 0;
+    double max_run_us = 0;
+    uint64_t blocked_tasks = 0; // ran over 1ms, less than half of it on the CPU
+};
+
+/**
+ * Lock-free accumulators behind PoolStats, shared by the pool types.
+ * Workers each own one and use the cheaper record_owned().
+ */
+class alignas(64) TaskStats
 {
 public:
-    ThreadPool(size_t num_threads);
-    ~ThreadPool();
+    // Safe from any thread
+    void record(std::chrono::nanoseconds wait, std::chrono::nanoseconds run);
+    // Only for stats a single thread ever writes: plain loads and stores, no read-modify-write
+    void record_owned(std::chrono::nanoseconds wait, std::chrono::nanoseconds run);
+    void record_blocked();
+
+    static PoolStats combine(const std::vector<const TaskStats*>& parts, size_t threads, size_t queued);
+
+private:
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> wait_ns_{0};
+    std::atomic<uint64_t> max_wait_ns_{0};
+    std::atomic<uint64_t> run_ns_{0};
+    std::atomic<uint64_t> max_run_ns_{0};
+    std::atomic<uint64_t> blocked_{0};
+};
+
+std::ostream& operator<<(std::ostream& out, const PoolStats& stats);
+
+/**
+ * A name for a kind of task, shown in watchdog reports. Labels are interned
+ * once, typically as function-local statics, so a task carries only a 16-bit
+ * id. Ids run out after kMaxLabels, later labels share id 0 ("task").
+ */
+class TaskLabel
+{
+public:
+    static constexpr uint16_t kMaxLabels = 4096;
+    // Id of tasks enqueued without a label
+    static constexpr uint16_t kUnlabeled = 0;
+
+    // name must outlive the program, a string literal in practice
+    explicit TaskLabel(const char* name);
+
+    uint16_t id() const { return id_; }
+    const char* name() const { return name_of(id_); }
+
+    static const char* name_of(uint16_t id);
+
+private:
+    uint16_t id_;
+};
+
+/**
+ * Queue policies: the container behind the pool's mutex. Capacity is a hard
+ * limit on top of PoolOptions::capacity, 0 means none.
+ */
+struct DequeQueue
+{
+    static constexpr size_t kCapacity = 0;
+
+    template <typename T>
+    using Container = std::deque<T>;
+};
+
+/**
+ * A fixed ring of N slots allocated up front, so queuing never allocates.
+ * Once it is full enqueue() applies the overflow policy as if PoolOptions::capacity were N.
+ */
+template <size_t N>
+struct RingQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "ring size must be a power of two");
+    static constexpr size_t kCapacity = N;
+
+    template <typename T>
+    class Container
+    {
+    public:
+        Container() : slots_(std::make_unique<T[]>(N))
+        {
+        }
 
+        bool empty() const { return head_ == tail_; }
+        size_t size() const { return tail_ - head_; }
+        T& front() { return slots_[head_ & (N - 1)]; }
+
+        void push_back(T&& value)
+        {
+            slots_[tail_++ & (N - 1)] = std::move(value);
+        }
+
+        void pop_front()
+        {
+            // Release whatever the moved-from task still holds
+            slots_[head_++ & (N - 1)] = T{};
+        }
+
+    private:
+        std::unique_ptr<T[]> slots_;
+        size_t head_ = 0;
+        size_t tail_ = 0;
+    };
+};
+
+/**
+ * Wait policies: what an idle worker does.
+ * ParkWait spins PoolOptions::spin_iterations rounds, then sleeps on the
+ * condition variable, and every submission has to wake it.
+ * SpinWait never sleeps: it relaxes spin_iterations rounds, then yields the
+ * core in a loop until work or shutdown shows up, and submitting skips the
+ * wake-up altogether. Only for pools with cores to themselves.
+ */
+struct ParkWait
+{
+    static constexpr bool kParks = true;
+};
+
+struct SpinWait
+{
+    static constexpr bool kParks = false;
+};
+
+/**
+ * Stats policies. FullStats keeps the task counters, the timings behind
+ * stats() and the watchdog's running slots. NoStats removes all of it from
+ * the task path, clock reads included unless CoDel needs them: the counters
+ * and stats() timings read zero.
+ */
+struct FullStats
+{
+    static constexpr bool kEnabled = true;
+};
+
+struct NoStats
+{
+    static constexpr bool kEnabled = false;
+};
+
+namespace pool_detail
+{
+    // CPU time the calling thread has used, for PoolOptions::track_blocking
+    std::chrono::nanoseconds thread_cpu_time();
+}
+
+/**
+ * The thread pool, configured at compile time. TaskType is the stored
+ * callable, std::function<void()> or anything default-constructible, movable,
+ * testable as a bool and callable with no arguments, such as InplaceTask.
+ * See ThreadPool and the presets below.
+ */
+template <typename QueuePolicy, typename WaitPolicy, typename TaskType, typename StatsPolicy>
+class BasicThreadPool
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    BasicThreadPool(size_t num_threads);
+    BasicThreadPool(size_t num_threads, const PoolOptions& options);
+    ~BasicThreadPool();
+
+    /**
+     * Queue a task, applying the overflow policy when the queue is full.
+     * Returns false if the task was rejected.
+     * With PoolOptions::local_batching, a call from one of this pool's workers
+     * puts the task in that worker's local buffer instead: it runs next on the
+     * same worker, or is published to the shared queue in one batch when the
+     * current task returns and another worker is idle. Buffered tasks bypass
+     * the capacity limit, a worker must never block on its own pool. Nor may
+     * the submitting task wait for a buffered task other than through
+     * TaskGroup::wait(): it would not start until the wait ended.
+     */
+    template <typename F>
+    bool enqueue(F&& task)
+    {
+        return enqueue_labeled(TaskLabel::kUnlabeled, std::forward<F>(task));
+    }
+
+    // As above, naming the task in watchdog reports
+    template <typename F>
+    bool enqueue(const TaskLabel& label, F&& task)
+    {
+        return enqueue_labeled(label.id(), std::forward<F>(task));
+    }
+
+    /**
+     * Queue a task only if there is room right now, never blocks
+     */
     template <typename F>
-    void enqueue(F&& task)
+    bool try_enqueue(F&& task)
     {
+        THREADING_SCHED_POINT();
         {
             std::unique_lock<std::mutex> lock(queue_mtx_);
-            tasks_.emplace(std::forward<F>(task));
+            if (is_full())
+            {
+                rejected_task_++;
+                return false;
+            }
+            tasks_.push_back(Task{TaskType(std::forward<F>(task)), timestamp(), TaskLabel::kUnlabeled});
+            publish_queued();
+        }
+        wake_one();
+        return true;
+    }
+
+    /**
+     * Split [0, count) into contiguous blocks and call fn(begin, end) for each,
+     * spread over the workers. The caller claims blocks too and returns once
+     * every block has run, so this is safe to call from inside a task. fn is
+     * called concurrently and must be safe to share.
+     */
+    template <typename F>
+    void parallel_for_blocks(size_t count, size_t block_size, F fn)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        struct Shared
+        {
+            F fn;
+            size_t count;
+            size_t block_size;
+            size_t blocks;
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex mtx;
+            std::condition_variable cv;
+
+            Shared(F f, size_t n, size_t b) : fn(std::move(f)), count(n), block_size(b), blocks((n + b - 1) / b)
+            {
+            }
+
+            // Helpers that start after the caller returned find no blocks left and exit
+            void work()
+            {
+                for (size_t b = next.fetch_add(1); b < blocks; b = next.fetch_add(1))
+                {
+                    size_t begin = b * block_size;
+                    fn(begin, std::min(count, begin + block_size));
+                    if (done.fetch_add(1) + 1 == blocks)
+                    {
+                        std::lock_guard<std::mutex> lock(mtx);
+                        cv.notify_all();
+                    }
+                }
+            }
+        };
+
+        auto shared = std::make_shared<Shared>(std::move(fn), count, std::max<size_t>(1, block_size));
+        size_t helpers = std::min(workers_.size(), shared->blocks - 1);
+        if (helpers > 0)
+        {
+            // Straight to the shared queue: helpers must reach idle workers even
+            // when called from a task, and are few enough to ignore the capacity.
+            // A full ring takes fewer, the caller runs what is left.
+            {
+                std::lock_guard<std::mutex> lock(queue_mtx_);
+                helpers = std::min(helpers, ring_room());
+                const auto now = timestamp();
+                for (size_t i = 0; i < helpers; ++i)
+                {
+                    tasks_.push_back(Task{[shared] { shared->work(); }, now, TaskLabel::kUnlabeled});
+                }
+                publish_queued();
+            }
+            wake_all();
+        }
+
+        shared->work();
+        std::unique_lock<std::mutex> lock(shared->mtx);
+        shared->cv.wait(lock, [&] { return shared->done.load() == shared->blocks; });
+    }
+
+    /**
+     * The calling worker's own T, default-constructed on first use and kept
+     * until the pool is destroyed, so tasks can reuse scratch space or build
+     * a partial result without allocating or locking. Every worker's instance
+     * sits on its own cache line. Threads outside the pool (CallerRuns, the
+     * caller's share of parallel_for_blocks) get one each as well, looked up
+     * under a mutex. Tag separates two uses of the same T.
+     */
+    template <typename T, typename Tag = T>
+    T& worker_local()
+    {
+        WorkerLocals<T>* locals = find_locals<T, Tag>();
+        if (!locals)
+        {
+            locals = add_locals<T, Tag>();
+        }
+        std::optional<T>* value;
+        if (on_worker())
+        {
+            value = &locals->slots[local_->index].value;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(locals->outside_mtx);
+            value = &locals->outside[std::this_thread::get_id()].value;
+        }
+        if (!*value)
+        {
+            value->emplace();
+        }
+        return **value;
+    }
+
+    /**
+     * Call fn(T&) on each worker's instance that was constructed, then on
+     * those of outside threads. Only safe while no task is using them, after
+     * a TaskGroup::wait() for instance.
+     */
+    template <typename T, typename Tag = T, typename F>
+    void combine_worker_locals(F fn)
+    {
+        WorkerLocals<T>* locals = find_locals<T, Tag>();
+        if (!locals)
+        {
+            return;
+        }
+        for (size_t i = 0; i < workers_.size(); ++i)
+        {
+            if (locals->slots[i].value)
+            {
+                fn(*locals->slots[i].value);
+            }
+        }
+        std::lock_guard<std::mutex> lock(locals->outside_mtx);
+        for (auto& [thread, slot] : locals->outside)
+        {
+            if (slot.value)
+            {
+                fn(*slot.value);
+            }
         }
-        cv_.notify_one();
     }
 
     int get_active_tasks() const;
     int get_completed_tasks() const;
     int get_pending_tasks();
+    int get_dropped_tasks() const;
+    int get_rejected_tasks() const;
+    size_t get_thread_count() const;
+    PoolStats stats();
 
 private:
+    friend class TaskGroup;
+    friend class Watchdog;
+
+    struct Task
+    {
+        TaskType fn;
+        Clock::time_point enqueued; // unset while in a worker's local buffer
+        uint16_t label;
+    };
+
+    /**
+     * What a worker is running, for the watchdog: start time in microseconds
+     * shifted over the label id, 0 while idle. Written only by its worker.
+     */
+    struct alignas(64) RunningSlot
+    {
+        std::atomic<uint64_t> running{0};
+    };
+
+    struct WorkerLocal
+    {
+        BasicThreadPool* pool;
+        size_t index;
+        TaskStats* stats;
+        std::atomic<uint64_t>* running;
+        std::vector<Task> tasks;
+    };
+
+    /**
+     * worker_local() storage: one node per (T, Tag) ever asked for, pushed
+     * onto a lock-free list and freed with the pool. Slot i belongs to worker
+     * i; threads outside the pool are kept apart by id, and a thread that
+     * reuses an exited one's id inherits its instance.
+     */
+    struct LocalsNode
+    {
+        const void* key;
+        LocalsNode* next = nullptr;
+
+        explicit LocalsNode(const void* k) : key(k)
+        {
+        }
+
+        virtual ~LocalsNode() = default;
+    };
+
+    template <typename T>
+    struct WorkerLocals : LocalsNode
+    {
+        struct alignas(64) Slot
+        {
+            std::optional<T> value;
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        std::mutex outside_mtx;
+        // Node-based, so an instance stays put while others are added
+        std::unordered_map<std::thread::id, Slot> outside;
+
+        WorkerLocals(const void* key, size_t count) : LocalsNode(key), slots(std::make_unique<Slot[]>(count))
+        {
+        }
+    };
+
+    // Its address identifies a (T, Tag) pair
+    template <typename T, typename Tag>
+    struct LocalsKey
+    {
+        static constexpr char id = 0;
+    };
+
+    template <typename T, typename Tag>
+    WorkerLocals<T>* find_locals(LocalsNode* node) const
+    {
+        for (; node; node = node->next)
+        {
+            if (node->key == &LocalsKey<T, Tag>::id)
+            {
+                return static_cast<WorkerLocals<T>*>(node);
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename T, typename Tag>
+    WorkerLocals<T>* find_locals() const
+    {
+        return find_locals<T, Tag>(locals_.load(std::memory_order_acquire));
+    }
+
+    // First use of a (T, Tag): publish its node, unless another thread got there first
+    template <typename T, typename Tag>
+    WorkerLocals<T>* add_locals()
+    {
+        auto fresh = std::make_unique<WorkerLocals<T>>(&LocalsKey<T, Tag>::id, workers_.size());
+        LocalsNode* head = locals_.load(std::memory_order_acquire);
+        while (true)
+        {
+            if (WorkerLocals<T>* existing = find_locals<T, Tag>(head))
+            {
+                return existing;
+            }
+            fresh->next = head;
+            if (locals_.compare_exchange_weak(head, fresh.get(), std::memory_order_acq_rel,
+                                              std::memory_order_acquire))
+            {
+                return fresh.release();
+            }
+        }
+    }
+
     void worker_thread(int id);
+    void drain_local(WorkerLocal& local, Clock::time_point last_end);
+    Task pop_task(Clock::time_point now, Clock::duration& wait, size_t& freed);
+    void notify_freed(size_t freed);
+    bool run_pending();
+    bool on_worker() const { return local_ && local_->pool == this; }
+    void spin_for_work() const;
+    void spin_until_work() const;
+
+    // Called under queue_mtx_ after every change to tasks_
+    void publish_queued() { queued_.store(tasks_.size(), std::memory_order_relaxed); }
+    bool is_full() const;
+    bool codel_should_drop(Clock::duration sojourn, Clock::time_point now);
+
+    // Slots left in a RingQueue, for pushes that bypass the capacity; called under queue_mtx_
+    size_t ring_room() const
+    {
+        return QueuePolicy::kCapacity == 0 ? SIZE_MAX : QueuePolicy::kCapacity - tasks_.size();
+    }
+
+    // Clock reads only feed the stats and CoDel, without either a task goes untimed
+    Clock::time_point timestamp() const
+    {
+        if constexpr (!StatsPolicy::kEnabled)
+        {
+            if (options_.codel_target.count() == 0)
+            {
+                return {};
+            }
+        }
+        return Clock::now();
+    }
+
+    // ParkWait workers sleep and need waking, SpinWait ones are watching queued_
+    void wake_one()
+    {
+        if constexpr (WaitPolicy::kParks)
+        {
+            cv_.notify_one();
+        }
+    }
+
+    void wake_all()
+    {
+        if constexpr (WaitPolicy::kParks)
+        {
+            cv_.notify_all();
+        }
+    }
+
+    std::chrono::nanoseconds start_task();
+    Clock::time_point finish_task(Clock::time_point start, std::chrono::nanoseconds cpu_start, Clock::duration wait);
+
+    /**
+     * Queue a task, applying the overflow policy; see enqueue()
+     */
+    template <typename F>
+    bool enqueue_labeled(uint16_t label, F&& task)
+    {
+        if (options_.local_batching && local_ && local_->pool == this)
+        {
+            local_->tasks.push_back(Task{TaskType(std::forward<F>(task)), {}, label});
+            return true;
+        }
+
+        THREADING_SCHED_POINT();
+        std::unique_lock<std::mutex> lock(queue_mtx_);
+        if (is_full())
+        {
+            switch (options_.overflow)
+            {
+            case OverflowPolicy::Block:
+                not_full_.wait(lock, [this] { return stop_ || !is_full(); });
+                if (ring_room() == 0)
+                {
+                    // Woken by shutdown with the ring still full
+                    rejected_task_++;
+                    return false;
+                }
+                break;
+            case OverflowPolicy::Reject:
+                rejected_task_++;
+                return false;
+            case OverflowPolicy::DropOldest:
+                tasks_.pop_front();
+                dropped_task_++;
+                break;
+            case OverflowPolicy::CallerRuns:
+                lock.unlock();
+                run_task(task, label, Clock::duration::zero(), timestamp());
+                return true;
+            }
+        }
+        tasks_.push_back(Task{TaskType(std::forward<F>(task)), timestamp(), label});
+        publish_queued();
+        lock.unlock();
+        THREADING_SCHED_POINT();
+        wake_one();
+        return true;
+    }
+
+    static uint64_t pack_running(Clock::time_point start, uint16_t label)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count();
+        return static_cast<uint64_t>(us) << 16 | label;
+    }
+
+    /**
+     * Run one task and record its timings. start is a clock reading the
+     * caller already has (dequeue time, or when the previous task ended), so
+     * each task costs a single clock read, and publishing it to the watchdog
+     * a single relaxed store. Returns when the task finished. Without stats
+     * it just runs the task.
+     */
+    template <typename F>
+    Clock::time_point run_task(F& task, uint16_t label, Clock::duration wait, Clock::time_point start)
+    {
+        if constexpr (!StatsPolicy::kEnabled)
+        {
+            task();
+            return start;
+        }
+        else
+        {
+            active_task_++;
+            if (on_worker())
+            {
+                local_->running->store(pack_running(start, label), std::memory_order_relaxed);
+            }
+            std::chrono::nanoseconds cpu_start = start_task();
+            task();
+            return finish_task(start, cpu_start, wait);
+        }
+    }
 
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
+    typename QueuePolicy::template Container<Task> tasks_;
+    PoolOptions options_;
 
     std::mutex queue_mtx_;
     std::condition_variable cv_;
-    bool stop_;
+    std::condition_variable not_full_;
+    // Written under queue_mtx_, atomic so spinning workers can watch it without the lock
+    std::atomic<bool> stop_;
+
+    // Last time a worker saw the queue drain, guarded by queue_mtx_
+    Clock::time_point last_empty_;
+
+    // Set on worker threads, lets enqueue() spot nested submissions
+    static thread_local WorkerLocal* local_;
+    std::atomic<int> idle_workers_;
+    // Copy of tasks_.size() spinning workers can watch without the lock
+    std::atomic<size_t> queued_{0};
 
     std::atomic<int> active_task_;
     std::atomic<int> completed_task_;
+    std::atomic<int> dropped_task_;
+    std::atomic<int> rejected_task_;
+    // One per worker, plus one for tasks run on the caller's thread
+    std::vector<std::unique_ptr<TaskStats>> worker_stats_;
+    std::vector<RunningSlot> running_;
+    TaskStats caller_stats_;
+    std::atomic<LocalsNode*> locals_{nullptr};
 };
 
+/**
+ * The general-purpose pool everything else in the project takes: a deque,
+ * parking workers, std::function tasks and full stats. TaskGroup, Watchdog,
+ * the executors and pipelines all work on this one.
+ */
+using ThreadPool = BasicThreadPool<DequeQueue, ParkWait, std::function<void()>, FullStats>;
+
+// Submission latency first: no allocation, no wake-up syscall, no clock reads
+using LowLatencyThreadPool = BasicThreadPool<RingQueue<1024>, SpinWait, InplaceTask<>, NoStats>;
+
+// Many short tasks on a shared machine: workers sleep when idle. Pair it with
+// PoolOptions::local_batching so nested tasks stay on their worker until another goes idle
+using ThroughputThreadPool = BasicThreadPool<DequeQueue, ParkWait, InplaceTask<>, NoStats>;
+
+// Everything the pool can report, for use with a Watchdog and track_blocking
+using DebugThreadPool = ThreadPool;
+
+template <typename Q, typename W, typename T, typename S>
+thread_local typename BasicThreadPool<Q, W, T, S>::WorkerLocal* BasicThreadPool<Q, W, T, S>::local_ = nullptr;
+
+template <typename Q, typename W, typename T, typename S>
+BasicThreadPool<Q, W, T, S>::BasicThreadPool(size_t num_threads)
+    : BasicThreadPool(num_threads, PoolOptions{})
+{
+}
+
+template <typename Q, typename W, typename T, typename S>
+BasicThreadPool<Q, W, T, S>::BasicThreadPool(size_t num_threads, const PoolOptions& options)
+    : options_(options), stop_(false), last_empty_(Clock::now()), idle_workers_(0),
+      active_task_(0), completed_task_(0), dropped_task_(0), rejected_task_(0), running_(num_threads)
+{
+    for (size_t i = 0; S::kEnabled && i < num_threads; ++i)
+    {
+        worker_stats_.push_back(std::make_unique<TaskStats>());
+    }
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        workers_.emplace_back([this, i]
+        {
+            worker_thread(i);
+        });
+    }
+    if (options_.verbose)
+    {
+        std::cout << "Thread pool created with " << num_threads << " workers" << std::endl;
+    }
+}
+
+template <typename Q, typename W, typename T, typename S>
+BasicThreadPool<Q, W, T, S>::~BasicThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(queue_mtx_);
+        stop_ = true;
+    }
+
+    cv_.notify_all();
+    not_full_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    for (LocalsNode* node = locals_.load(); node;)
+    {
+        delete std::exchange(node, node->next);
+    }
+
+    if (options_.verbose)
+    {
+        std::cout << "Thread pool destroyed" << std::endl;
+    }
+}
+
+template <typename Q, typename W, typename T, typename S>
+int BasicThreadPool<Q, W, T, S>::get_active_tasks() const
+{
+    return active_task_;
+}
+
+template <typename Q, typename W, typename T, typename S>
+int BasicThreadPool<Q, W, T, S>::get_completed_tasks() const
+{
+    return completed_task_;
+}
+
+template <typename Q, typename W, typename T, typename S>
+int BasicThreadPool<Q, W, T, S>::get_pending_tasks()
+{
+    std::unique_lock<std::mutex> lock(queue_mtx_);
+    return tasks_.size();
+}
+
+template <typename Q, typename W, typename T, typename S>
+int BasicThreadPool<Q, W, T, S>::get_dropped_tasks() const
+{
+    return dropped_task_;
+}
+
+template <typename Q, typename W, typename T, typename S>
+int BasicThreadPool<Q, W, T, S>::get_rejected_tasks() const
+{
+    return rejected_task_;
+}
+
+template <typename Q, typename W, typename T, typename S>
+size_t BasicThreadPool<Q, W, T, S>::get_thread_count() const
+{
+    return workers_.size();
+}
+
+template <typename Q, typename W, typename T, typename S>
+PoolStats BasicThreadPool<Q, W, T, S>::stats()
+{
+    std::vector<const TaskStats*> parts{&caller_stats_};
+    for (const auto& worker : worker_stats_)
+    {
+        parts.push_back(worker.get());
+    }
+    return TaskStats::combine(parts, workers_.size(), get_pending_tasks());
+}
+
+template <typename Q, typename W, typename T, typename S>
+std::chrono::nanoseconds BasicThreadPool<Q, W, T, S>::start_task()
+{
+    return options_.track_blocking ? pool_detail::thread_cpu_time() : std::chrono::nanoseconds::zero();
+}
+
+template <typename Q, typename W, typename T, typename S>
+typename BasicThreadPool<Q, W, T, S>::Clock::time_point BasicThreadPool<Q, W, T, S>::finish_task(
+    Clock::time_point start, std::chrono::nanoseconds cpu_start, Clock::duration wait)
+{
+    const auto end = Clock::now();
+    const auto run = end - start;
+    const bool on_worker = local_ && local_->pool == this;
+    TaskStats& stats = on_worker ? *local_->stats : caller_stats_;
+
+    if (options_.track_blocking && run > std::chrono::milliseconds(1)
+        && (pool_detail::thread_cpu_time() - cpu_start) * 2 < run)
+    {
+        stats.record_blocked();
+    }
+    if (on_worker)
+    {
+        stats.record_owned(wait, run);
+    }
+    else
+    {
+        stats.record(wait, run);
+    }
+    active_task_--;
+    completed_task_++;
+    return end;
+}
+
+template <typename Q, typename W, typename T, typename S>
+bool BasicThreadPool<Q, W, T, S>::is_full() const
+{
+    return (options_.capacity != 0 && tasks_.size() >= options_.capacity) || ring_room() == 0;
+}
+
+/**
+ * CoDel-style admission control adapted to a task queue: while the queue keeps
+ * draining, tasks may wait up to a full interval; once it has not been empty
+ * for an interval we are overloaded and anything older than target is shed.
+ * Called under queue_mtx_ with the task already popped.
+ */
+template <typename Q, typename W, typename T, typename S>
+bool BasicThreadPool<Q, W, T, S>::codel_should_drop(Clock::duration sojourn, Clock::time_point now)
+{
+    if (options_.codel_target.count() == 0)
+    {
+        return false;
+    }
+
+    if (tasks_.empty())
+    {
+        last_empty_ = now;
+    }
+
+    const bool overloaded = now - last_empty_ > options_.codel_interval;
+    return sojourn > (overloaded ? options_.codel_target : options_.codel_interval);
+}
+
+/**
+ * Pop the next task, shedding any the admission controller rejects. Called
+ * under queue_mtx_; freed counts every slot popped, run or shed.
+ */
+template <typename Q, typename W, typename T, typename S>
+typename BasicThreadPool<Q, W, T, S>::Task BasicThreadPool<Q, W, T, S>::pop_task(Clock::time_point now,
+                                                                                 Clock::duration& wait, size_t& freed)
+{
+    while (!tasks_.empty())
+    {
+        Task next = std::move(tasks_.front());
+        tasks_.pop_front();
+        freed++;
+        wait = now - next.enqueued;
+        if (!codel_should_drop(wait, now))
+        {
+            publish_queued();
+            return next;
+        }
+        dropped_task_++;
+    }
+    publish_queued();
+    return {};
+}
+
+template <typename Q, typename W, typename T, typename S>
+void BasicThreadPool<Q, W, T, S>::notify_freed(size_t freed)
+{
+    if ((options_.capacity == 0 && Q::kCapacity == 0) || freed == 0)
+    {
+        return;
+    }
+    if (freed > 1)
+    {
+        not_full_.notify_all();
+    }
+    else
+    {
+        not_full_.notify_one();
+    }
+}
+
+/**
+ * Run one task on behalf of a waiting worker: its own buffered tasks first,
+ * then the shared queue. Returns false when there was nothing to run or the
+ * caller is not one of this pool's workers.
+ */
+template <typename Q, typename W, typename T, typename S>
+bool BasicThreadPool<Q, W, T, S>::run_pending()
+{
+    if (!on_worker())
+    {
+        return false;
+    }
+
+    Task task;
+    Clock::duration wait{};
+    Clock::time_point start;
+    if (!local_->tasks.empty())
+    {
+        task = std::move(local_->tasks.back());
+        local_->tasks.pop_back();
+        start = timestamp();
+    }
+    else
+    {
+        size_t freed = 0;
+        {
+            std::lock_guard<std::mutex> lock(queue_mtx_);
+            start = timestamp();
+            task = pop_task(start, wait, freed);
+        }
+        notify_freed(freed);
+    }
+    if (!task.fn)
+    {
+        return false;
+    }
+    THREADING_SCHED_POINT();
+    // The helped task overwrites the waiting task's watchdog slot, put it back after
+    const uint64_t waiting = local_->running->load(std::memory_order_relaxed);
+    run_task(task.fn, task.label, wait, start);
+    local_->running->store(waiting, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Busy-wait a bounded number of rounds for the queue to fill, so a task that
+ * arrives right after the last one finished skips the sleep and wake-up
+ */
+template <typename Q, typename W, typename T, typename S>
+void BasicThreadPool<Q, W, T, S>::spin_for_work() const
+{
+    for (unsigned i = 0; i < options_.spin_iterations; ++i)
+    {
+        if (queued_.load(std::memory_order_relaxed) != 0)
+        {
+            return;
+        }
+        cpu_relax();
+    }
+}
+
+/**
+ * SpinWait's idle loop, run without the lock: relax the core for
+ * spin_iterations rounds, then keep yielding it until work or shutdown
+ */
+template <typename Q, typename W, typename T, typename S>
+void BasicThreadPool<Q, W, T, S>::spin_until_work() const
+{
+    for (unsigned i = 0; queued_.load(std::memory_order_relaxed) == 0 && !stop_.load(std::memory_order_relaxed); ++i)
+    {
+        if (i < options_.spin_iterations)
+        {
+            cpu_relax();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template <typename Q, typename W, typename T, typename S>
+void BasicThreadPool<Q, W, T, S>::worker_thread(int id)
+{
+    if (options_.verbose)
+    {
+        std::cout << "Worker " << id << " started" << std::endl;
+    }
+    THREADING_SCHED_THREAD(1000 + id);
+    WorkerLocal local{this, static_cast<size_t>(id), S::kEnabled ? worker_stats_[id].get() : nullptr,
+                      &running_[id].running, {}};
+    local_ = &local;
+    auto has_work = [this]
+    {
+        return stop_ || !tasks_.empty();
+    };
+    while (true)
+    {
+        Task task;
+        Clock::duration wait{};
+        Clock::time_point dequeued;
+        size_t freed = 0;
+        if constexpr (W::kParks)
+        {
+            spin_for_work();
+        }
+        {
+            std::unique_lock<std::mutex> lock(queue_mtx_);
+            if (tasks_.empty())
+            {
+                // Going to sleep, stop reporting the last task as running
+                local.running->store(0, std::memory_order_relaxed);
+            }
+            idle_workers_++;
+            if constexpr (W::kParks)
+            {
+                cv_.wait(lock, has_work);
+            }
+            else
+            {
+                while (!has_work())
+                {
+                    lock.unlock();
+                    spin_until_work();
+                    lock.lock();
+                }
+            }
+            idle_workers_--;
+
+            THREADING_SCHED_POINT();
+
+            // Exit if we're stopping and no tasks remain
+            if (stop_ && tasks_.empty())
+            {
+                break;
+            }
+
+            dequeued = timestamp();
+            task = pop_task(dequeued, wait, freed);
+        }
+        notify_freed(freed);
+        if (task.fn)
+        {
+            THREADING_SCHED_POINT();
+            drain_local(local, run_task(task.fn, task.label, wait, dequeued));
+        }
+    }
+    local_ = nullptr;
+    if (options_.verbose)
+    {
+        std::cout << "Worker " << id << " completed" << std::endl;
+    }
+}
+
+/**
+ * Run what the last task submitted, newest first. When other workers are idle
+ * everything but the newest task is handed to them in one batch, as much of
+ * it as a RingQueue has room for.
+ */
+template <typename Q, typename W, typename T, typename S>
+void BasicThreadPool<Q, W, T, S>::drain_local(WorkerLocal& local, Clock::time_point last_end)
+{
+    while (!local.tasks.empty())
+    {
+        int idle = idle_workers_.load(std::memory_order_relaxed);
+        size_t spare = local.tasks.size() - 1;
+        if (idle > 0 && spare > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(queue_mtx_);
+                spare = std::min(spare, ring_room());
+                const auto now = timestamp();
+                for (size_t i = 0; i < spare; ++i)
+                {
+                    local.tasks[i].enqueued = now;
+                    tasks_.push_back(std::move(local.tasks[i]));
+                }
+                publish_queued();
+            }
+            local.tasks.erase(local.tasks.begin(), local.tasks.begin() + spare);
+
+            if (spare >= static_cast<size_t>(idle))
+            {
+                wake_all();
+            }
+            else
+            {
+                for (size_t i = 0; i < spare; ++i)
+                {
+                    wake_one();
+                }
+            }
+        }
+
+        Task next = std::move(local.tasks.back());
+        local.tasks.pop_back();
+        last_end = run_task(next.fn, next.label, Clock::duration::zero(), last_end);
+    }
+}
+
 void request(int request_id);
 void compute_task(int id, int value);
 
-void basic_usage();
-void dynamic_tasks();
-void shared_state();
+void basic_usage(size_t threads, const PoolOptions& options);
+void dynamic_tasks(size_t threads, const PoolOptions& options);
+void shared_state(size_t threads, const PoolOptions& options);
+void overload();
 
 #endif // POOL_H
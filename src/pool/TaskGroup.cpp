@@ -0,0 +1,48 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "TaskGroup.h"
+
+#include "Futex.h"
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool_(pool)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+uint32_t TaskGroup::pending() const
+{
+    return pending_.load(std::memory_order_acquire);
+}
+
+void TaskGroup::finish_one()
+{
+    THREADING_SCHED_POINT();
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        futex_wake_all(pending_);
+    }
+}
+
+void TaskGroup::wait()
+{
+    const bool helping = pool_.on_worker();
+    // A helping worker naps briefly so it notices tasks queued while it slept
+    const timespec nap{0, 200000};
+
+    for (uint32_t n = pending(); n != 0; n = pending())
+    {
+        THREADING_SCHED_POINT();
+        if (helping && pool_.run_pending())
+        {
+            continue;
+        }
+        futex_wait(pending_, n, helping ? &nap : nullptr);
+    }
+}
@@ -0,0 +1,90 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef TASKGROUP_H
+#define TASKGROUP_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "Pool.h"
+
+/**
+ * Tracks a set of tasks submitted to a ThreadPool and waits for just those,
+ * regardless of what else the pool is running.
+ *
+ * Outside the pool wait() sleeps on a futex that the last task to finish
+ * wakes. On one of the pool's own workers it runs queued tasks while it
+ * waits, so a task can fork children and join them without starving the pool.
+ * Tasks the pool sheds or rejects count as finished.
+ */
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool& pool);
+    // Waits for anything still outstanding
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F&& fn)
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.enqueue([done = Completion(this), fn = std::forward<F>(fn)]() mutable
+        {
+            fn();
+            done.signal();
+        });
+    }
+
+    void wait();
+
+    // Tasks submitted through run() that have not finished yet
+    uint32_t pending() const;
+
+private:
+    /**
+     * Signals the group once, either after the task ran or when the pool
+     * destroys it unrun. std::function wants a copyable target, so a copy
+     * takes over the duty from the original instead of sharing it.
+     */
+    struct Completion
+    {
+        mutable TaskGroup* group;
+
+        explicit Completion(TaskGroup* g) : group(g)
+        {
+        }
+
+        Completion(const Completion& other) : group(std::exchange(other.group, nullptr))
+        {
+        }
+
+        Completion& operator=(const Completion&) = delete;
+
+        void signal()
+        {
+            if (group)
+            {
+                std::exchange(group, nullptr)->finish_one();
+            }
+        }
+
+        ~Completion()
+        {
+            signal();
+        }
+    };
+
+    void finish_one();
+
+    ThreadPool& pool_;
+    // Doubles as the futex word, waiters sleep until it reaches zero
+    std::atomic<uint32_t> pending_{0};
+};
+
+#endif // TASKGROUP_H
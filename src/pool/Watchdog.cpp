@@ -0,0 +1,150 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Watchdog.h"
+#include "TaskGroup.h"
+
+#include <iostream>
+#include <utility>
+
+Watchdog::Watchdog(ThreadPool& pool, WatchdogOptions options)
+    : pool_(pool), options_(std::move(options)), reported_(pool.running_.size(), 0),
+      last_completed_(pool.get_completed_tasks()), last_progress_(Clock::now()), stall_reported_(false),
+      reports_(0), stop_(false)
+{
+    thread_ = std::thread([this] { monitor(); });
+}
+
+Watchdog::~Watchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+uint64_t Watchdog::get_reports() const
+{
+    return reports_.load(std::memory_order_relaxed);
+}
+
+void Watchdog::monitor()
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (!cv_.wait_for(lock, options_.scan_interval, [this] { return stop_; }))
+    {
+        lock.unlock();
+        scan(Clock::now());
+        lock.lock();
+    }
+}
+
+void Watchdog::scan(Clock::time_point now)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using std::chrono::milliseconds;
+
+    const auto now_us = static_cast<uint64_t>(duration_cast<microseconds>(now.time_since_epoch()).count());
+    const auto budget_us = static_cast<uint64_t>(duration_cast<microseconds>(options_.budget).count());
+    const size_t queued = pool_.queued_.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < reported_.size(); ++i)
+    {
+        const uint64_t running = pool_.running_[i].running.load(std::memory_order_relaxed);
+        const uint64_t started_us = running >> 16;
+        if (running == 0 || running == reported_[i] || started_us > now_us || now_us - started_us <= budget_us)
+        {
+            continue;
+        }
+        reported_[i] = running;
+        report(WatchdogReport{WatchdogReport::Kind::LongTask, static_cast<int>(i),
+                              TaskLabel::name_of(static_cast<uint16_t>(running & 0xffff)),
+                              duration_cast<milliseconds>(microseconds(now_us - started_us)), queued});
+    }
+
+    // Progress is any task finishing, or nothing left to do
+    const int completed = pool_.get_completed_tasks();
+    if (completed != last_completed_ || queued == 0)
+    {
+        last_completed_ = completed;
+        last_progress_ = now;
+        stall_reported_ = false;
+    }
+    else if (!stall_reported_ && now - last_progress_ > options_.stall_timeout)
+    {
+        stall_reported_ = true;
+        report(WatchdogReport{WatchdogReport::Kind::QueueStall, -1, nullptr,
+                              duration_cast<milliseconds>(now - last_progress_), queued});
+    }
+}
+
+void Watchdog::report(const WatchdogReport& report)
+{
+    reports_.fetch_add(1, std::memory_order_relaxed);
+    if (options_.on_report)
+    {
+        options_.on_report(report);
+        return;
+    }
+    if (report.kind == WatchdogReport::Kind::LongTask)
+    {
+        std::cerr << "Watchdog: worker " << report.worker << " has run '" << report.label << "' for "
+            << report.elapsed.count() << "ms" << std::endl;
+    }
+    else
+    {
+        std::cerr << "Watchdog: queue stalled for " << report.elapsed.count() << "ms with "
+            << report.queued << " tasks waiting" << std::endl;
+    }
+}
+
+void watchdog()
+{
+    std::cout << "example 9: Watchdog for Stuck Workers" << std::endl;
+
+    ThreadPool pool(2);
+    WatchdogOptions options;
+    options.budget = std::chrono::milliseconds(100);
+    options.stall_timeout = std::chrono::milliseconds(150);
+    options.scan_interval = std::chrono::milliseconds(20);
+    options.on_report = [](const WatchdogReport& report)
+    {
+        if (report.kind == WatchdogReport::Kind::LongTask)
+        {
+            std::cout << "Watchdog: worker " << report.worker << " stuck in '" << report.label << "' for "
+                << report.elapsed.count() << "ms" << std::endl;
+        }
+        else
+        {
+            std::cout << "Watchdog: no task finished for " << report.elapsed.count() << "ms, "
+                << report.queued << " waiting" << std::endl;
+        }
+    };
+    Watchdog dog(pool, options);
+
+    // Two slow requests hold both workers, like request() would, and the quick tasks pile up behind them
+    static const TaskLabel slow_request("request");
+    static const TaskLabel quick("compute");
+    TaskGroup group(pool);
+    for (int i = 1; i <= 2; ++i)
+    {
+        pool.enqueue(slow_request, [i]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(400));
+            std::cout << "Request " << i << " done" << std::endl;
+        });
+    }
+    for (int i = 1; i <= 4; ++i)
+    {
+        group.run([i]
+        {
+            std::cout << "Compute task " << i << " done" << std::endl;
+        });
+    }
+    group.wait();
+    std::cout << "Watchdog reports: " << dog.get_reports() << std::endl;
+}
@@ -0,0 +1,88 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Pool.h"
+
+struct WatchdogReport
+{
+    enum class Kind
+    {
+        LongTask,  // a task has run past the budget
+        QueueStall // tasks are queued but none has finished for stall_timeout
+    };
+
+    Kind kind;
+    int worker;        // -1 for a queue stall
+    const char* label; // the task's TaskLabel name, nullptr for a queue stall
+    std::chrono::milliseconds elapsed;
+    size_t queued;
+};
+
+struct WatchdogOptions
+{
+    std::chrono::milliseconds budget{1000};
+    std::chrono::milliseconds stall_timeout{1000};
+    std::chrono::milliseconds scan_interval{100};
+    // Called on the monitor thread; prints to std::cerr when empty
+    std::function<void(const WatchdogReport&)> on_report;
+};
+
+/**
+ * Watches a ThreadPool from its own thread. Every scan_interval it reads each
+ * worker's running slot (start time and label of the current task, published
+ * with one relaxed store per task) and reports tasks over budget, once per
+ * task. It also reports once when the queue is non-empty but no task has
+ * finished for stall_timeout, which catches every worker being stuck at once.
+ * Destroy it before the pool.
+ */
+class Watchdog
+{
+public:
+    explicit Watchdog(ThreadPool& pool, WatchdogOptions options = {});
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    uint64_t get_reports() const;
+
+private:
+    using Clock = ThreadPool::Clock;
+
+    void monitor();
+    void scan(Clock::time_point now);
+    void report(const WatchdogReport& report);
+
+    ThreadPool& pool_;
+    WatchdogOptions options_;
+
+    // Monitor thread only
+    std::vector<uint64_t> reported_; // last slot value reported, per worker
+    int last_completed_;
+    Clock::time_point last_progress_;
+    bool stall_reported_;
+
+    std::atomic<uint64_t> reports_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_;
+    std::thread thread_;
+};
+
+void watchdog();
+
+#endif // WATCHDOG_H
@@ -0,0 +1,338 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Kernels.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define THREADING_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+Divisor::Divisor(uint32_t divisor) : d(divisor)
+{
+    if (divisor == 0)
+    {
+        throw std::invalid_argument("Divisor: division by zero");
+    }
+    // l = ceil(log2 d), m = floor(2^32 * (2^l - d) / d) + 1
+    unsigned l = 0;
+    while ((uint64_t(1) << l) < divisor)
+    {
+        l++;
+    }
+    multiplier = static_cast<uint32_t>(((uint64_t(1) << 32) * ((uint64_t(1) << l) - divisor)) / divisor + 1);
+    shift1 = l < 1 ? l : 1;
+    shift2 = l > 0 ? l - 1 : 0;
+}
+
+uint64_t mod_sum_naive(uint32_t begin, uint32_t end, uint32_t divisor)
+{
+    uint64_t sum = 0;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        sum += i % divisor;
+    }
+    return sum;
+}
+
+namespace
+{
+    uint64_t mod_sum_scalar(uint32_t begin, uint32_t end, const Divisor& divisor)
+    {
+        uint64_t sum = 0;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            sum += divisor.mod(i);
+        }
+        return sum;
+    }
+
+    /**
+     * Remainders are summed in 32-bit lanes; this many vectors can be added
+     * before a lane might overflow and has to be flushed to 64 bits
+     */
+    uint32_t flush_interval(const Divisor& divisor)
+    {
+        return divisor.d <= 1 ? UINT32_MAX : UINT32_MAX / (divisor.d - 1);
+    }
+
+#ifdef THREADING_X86_SIMD
+    __attribute__((target("sse4.1")))
+    uint64_t mod_sum_sse41(uint32_t begin, uint32_t end, const Divisor& divisor)
+    {
+        const __m128i m = _mm_set1_epi32(static_cast<int>(divisor.multiplier));
+        const __m128i d = _mm_set1_epi32(static_cast<int>(divisor.d));
+        const __m128i sh1 = _mm_cvtsi32_si128(static_cast<int>(divisor.shift1));
+        const __m128i sh2 = _mm_cvtsi32_si128(static_cast<int>(divisor.shift2));
+        const __m128i step = _mm_set1_epi32(4);
+        const uint32_t flush = flush_interval(divisor);
+
+        __m128i x = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(begin)), _mm_setr_epi32(0, 1, 2, 3));
+        uint64_t sum = 0;
+        uint32_t i = begin;
+        while (end - i >= 4)
+        {
+            __m128i acc = _mm_setzero_si128();
+            for (uint32_t n = 0; n < flush && end - i >= 4; ++n, i += 4)
+            {
+                // multiply-high of even and odd lanes, recombined
+                __m128i even = _mm_srli_epi64(_mm_mul_epu32(x, m), 32);
+                __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), m);
+                __m128i t = _mm_blend_epi16(even, odd, 0xCC);
+                __m128i q = _mm_srl_epi32(_mm_add_epi32(t, _mm_srl_epi32(_mm_sub_epi32(x, t), sh1)), sh2);
+                acc = _mm_add_epi32(acc, _mm_sub_epi32(x, _mm_mullo_epi32(q, d)));
+                x = _mm_add_epi32(x, step);
+            }
+            alignas(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            sum += uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+        return sum + mod_sum_scalar(i, end, divisor);
+    }
+
+    __attribute__((target("avx2")))
+    uint64_t mod_sum_avx2(uint32_t begin, uint32_t end, const Divisor& divisor)
+    {
+        const __m256i m = _mm256_set1_epi32(static_cast<int>(divisor.multiplier));
+        const __m256i d = _mm256_set1_epi32(static_cast<int>(divisor.d));
+        const __m128i sh1 = _mm_cvtsi32_si128(static_cast<int>(divisor.shift1));
+        const __m128i sh2 = _mm_cvtsi32_si128(static_cast<int>(divisor.shift2));
+        const __m256i step = _mm256_set1_epi32(8);
+        const uint32_t flush = flush_interval(divisor);
+
+        __m256i x = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)),
+                                     _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        uint64_t sum = 0;
+        uint32_t i = begin;
+        while (end - i >= 8)
+        {
+            __m256i acc = _mm256_setzero_si256();
+            for (uint32_t n = 0; n < flush && end - i >= 8; ++n, i += 8)
+            {
+                __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, m), 32);
+                __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m);
+                __m256i t = _mm256_blend_epi32(even, odd, 0xAA);
+                __m256i q = _mm256_srl_epi32(_mm256_add_epi32(t, _mm256_srl_epi32(_mm256_sub_epi32(x, t), sh1)), sh2);
+                acc = _mm256_add_epi32(acc, _mm256_sub_epi32(x, _mm256_mullo_epi32(q, d)));
+                x = _mm256_add_epi32(x, step);
+            }
+            alignas(32) uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+            for (uint32_t lane : lanes)
+            {
+                sum += lane;
+            }
+        }
+        return sum + mod_sum_scalar(i, end, divisor);
+    }
+
+    // GCC's AVX-512 intrinsics pass a deliberately uninitialised _mm512_undefined_*()
+    // as the unused merge source, which -Wmaybe-uninitialized flags once they inline
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    __attribute__((target("avx512f")))
+    uint64_t mod_sum_avx512(uint32_t begin, uint32_t end, const Divisor& divisor)
+    {
+        const __m512i m = _mm512_set1_epi32(static_cast<int>(divisor.multiplier));
+        const __m512i d = _mm512_set1_epi32(static_cast<int>(divisor.d));
+        const __m128i sh1 = _mm_cvtsi32_si128(static_cast<int>(divisor.shift1));
+        const __m128i sh2 = _mm_cvtsi32_si128(static_cast<int>(divisor.shift2));
+        const __m512i step = _mm512_set1_epi32(16);
+        const uint32_t flush = flush_interval(divisor);
+
+        __m512i x = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(begin)),
+                                     _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        uint64_t sum = 0;
+        uint32_t i = begin;
+        while (end - i >= 16)
+        {
+            __m512i acc = _mm512_setzero_si512();
+            for (uint32_t n = 0; n < flush && end - i >= 16; ++n, i += 16)
+            {
+                __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(x, m), 32);
+                __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), m);
+                __m512i t = _mm512_mask_blend_epi32(0xAAAA, even, odd);
+                __m512i q = _mm512_srl_epi32(_mm512_add_epi32(t, _mm512_srl_epi32(_mm512_sub_epi32(x, t), sh1)), sh2);
+                acc = _mm512_add_epi32(acc, _mm512_sub_epi32(x, _mm512_mullo_epi32(q, d)));
+                x = _mm512_add_epi32(x, step);
+            }
+            // widen to 64-bit lanes before the horizontal add
+            __m512i lo = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(acc));
+            __m512i hi = _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(acc, 1));
+            sum += static_cast<uint64_t>(_mm512_reduce_add_epi64(_mm512_add_epi64(lo, hi)));
+        }
+        return sum + mod_sum_scalar(i, end, divisor);
+    }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+    SimdLevel parse_level(const char* name, SimdLevel fallback)
+    {
+        if (!name)
+        {
+            return fallback;
+        }
+        for (auto level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512})
+        {
+            if (std::strcmp(name, simd_name(level)) == 0)
+            {
+                return level;
+            }
+        }
+        return fallback;
+    }
+}
+
+bool simd_supported(SimdLevel level)
+{
+#ifdef THREADING_X86_SIMD
+    // __builtin_cpu_supports reads CPUID and checks the OS saves the wider registers
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return true;
+    case SimdLevel::SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case SimdLevel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case SimdLevel::AVX512:
+        return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return level == SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel detect_simd()
+{
+    SimdLevel best = SimdLevel::Scalar;
+    for (auto level : {SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512})
+    {
+        if (simd_supported(level))
+        {
+            best = level;
+        }
+    }
+    SimdLevel cap = parse_level(std::getenv("THREADING_SIMD"), best);
+    return cap < best ? cap : best;
+}
+
+const char* simd_name(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::SSE41:
+        return "sse4.1";
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+ModSumKernel mod_sum_kernel(SimdLevel level)
+{
+#ifdef THREADING_X86_SIMD
+    if (simd_supported(level))
+    {
+        switch (level)
+        {
+        case SimdLevel::AVX512:
+            return mod_sum_avx512;
+        case SimdLevel::AVX2:
+            return mod_sum_avx2;
+        case SimdLevel::SSE41:
+            return mod_sum_sse41;
+        case SimdLevel::Scalar:
+            break;
+        }
+    }
+#endif
+    return mod_sum_scalar;
+}
+
+std::vector<uint64_t> compute_batch(ThreadPool& pool, const std::vector<int>& values, uint32_t iterations,
+                                    size_t block_size)
+{
+    static const ModSumKernel kernel = mod_sum_kernel(detect_simd());
+
+    // Checked here: a Divisor throwing on a worker would take the process down
+    for (int value : values)
+    {
+        if (value == 0)
+        {
+            throw std::invalid_argument("compute_batch: division by zero");
+        }
+    }
+    std::vector<uint64_t> results(values.size());
+    pool.parallel_for_blocks(values.size(), block_size, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            results[i] = kernel(0, iterations, Divisor(static_cast<uint32_t>(values[i])));
+        }
+    });
+    return results;
+}
+
+void simd_kernels(size_t threads, const PoolOptions& options)
+{
+    std::cout << "example 6: SIMD Batch Kernels" << std::endl;
+    std::cout << "Best SIMD level: " << simd_name(detect_simd()) << std::endl;
+
+    const uint32_t iterations = 1000000;
+    const uint32_t value = 107;
+    const uint64_t expected = mod_sum_naive(0, iterations, value);
+
+    auto time_ms = [](auto&& fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    uint64_t naive = 0;
+    double naive_ms = time_ms([&] { naive = mod_sum_naive(0, iterations, value); });
+    std::cout << std::left << std::setw(10) << "naive %" << std::right << std::setw(10) << std::fixed
+        << std::setprecision(3) << naive_ms << " ms  result " << naive << std::endl;
+
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512})
+    {
+        if (!simd_supported(level))
+        {
+            continue;
+        }
+        ModSumKernel kernel = mod_sum_kernel(level);
+        uint64_t result = 0;
+        double ms = time_ms([&] { result = kernel(0, iterations, Divisor(value)); });
+        std::cout << std::left << std::setw(10) << simd_name(level) << std::right << std::setw(10) << ms
+            << " ms  result " << result << (result == expected ? "" : "  MISMATCH") << std::endl;
+    }
+
+    ThreadPool pool(threads, options);
+    std::vector<int> values;
+    for (int i = 1; i <= 64; ++i)
+    {
+        values.push_back(100 + i);
+    }
+    std::vector<uint64_t> results;
+    double batch_ms = time_ms([&] { results = compute_batch(pool, values, iterations); });
+    std::cout << "compute_batch of " << values.size() << " tasks on the pool: " << batch_ms << " ms, task 1 result "
+        << results[0] << std::endl;
+}
@@ -0,0 +1,79 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Pool.h"
+
+/**
+ * A divisor prepared once for many divisions (Granlund & Montgomery, "Division
+ * by Invariant Integers using Multiplication"): x / d becomes a multiply-high,
+ * a subtract and two shifts, all of which have SIMD forms unlike integer divide.
+ */
+struct Divisor
+{
+    uint32_t d;
+    uint32_t multiplier;
+    unsigned shift1;
+    unsigned shift2;
+
+    // Any divisor from 1 to 2^32 - 1; 0 throws std::invalid_argument
+    explicit Divisor(uint32_t divisor);
+
+    uint32_t divide(uint32_t x) const
+    {
+        uint32_t t = static_cast<uint32_t>((static_cast<uint64_t>(x) * multiplier) >> 32);
+        return (t + ((x - t) >> shift1)) >> shift2;
+    }
+
+    uint32_t mod(uint32_t x) const
+    {
+        return x - divide(x) * d;
+    }
+};
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE41,
+    AVX2,
+    AVX512
+};
+
+/**
+ * sum of (i % divisor) for i in [begin, end) - the loop compute_task runs
+ */
+using ModSumKernel = uint64_t (*)(uint32_t begin, uint32_t end, const Divisor& divisor);
+
+/**
+ * The best level this CPU and OS support. THREADING_SIMD=scalar|sse4.1|avx2|avx512
+ * in the environment caps it, for testing the fallbacks.
+ */
+SimdLevel detect_simd();
+bool simd_supported(SimdLevel level);
+const char* simd_name(SimdLevel level);
+
+ModSumKernel mod_sum_kernel(SimdLevel level);
+
+/**
+ * The plain % loop, for reference; divisor must not be 0
+ */
+uint64_t mod_sum_naive(uint32_t begin, uint32_t end, uint32_t divisor);
+
+/**
+ * Run compute_task's kernel for every value, each worker taking a contiguous
+ * block of values and the vector kernel chosen at startup. Values are used as
+ * uint32_t divisors; a 0 throws std::invalid_argument before anything is queued.
+ */
+std::vector<uint64_t> compute_batch(ThreadPool& pool, const std::vector<int>& values, uint32_t iterations,
+                                    size_t block_size = 16);
+
+void simd_kernels(size_t threads, const PoolOptions& options);
+
+#endif // KERNELS_H
@@ -0,0 +1,152 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "History.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+History::History(size_t threads) : clock_(0), logs_(threads)
+{
+}
+
+uint64_t History::tick()
+{
+    return clock_.fetch_add(1) + 1;
+}
+
+void History::record(size_t thread, const QueueOp& op)
+{
+    logs_[thread].push_back(op);
+}
+
+std::vector<QueueOp> History::merged() const
+{
+    std::vector<QueueOp> ops;
+    for (const auto& log : logs_)
+    {
+        ops.insert(ops.end(), log.begin(), log.end());
+    }
+    return ops;
+}
+
+std::vector<std::string> check_fifo_history(const std::vector<QueueOp>& ops, size_t capacity)
+{
+    std::vector<std::string> errors;
+    auto fail = [&errors](const std::string& message)
+    {
+        if (errors.size() < 20)
+        {
+            errors.push_back(message);
+        }
+    };
+
+    std::unordered_map<long long, const QueueOp*> pushes;
+    std::unordered_map<long long, const QueueOp*> pops;
+    for (const auto& op : ops)
+    {
+        auto& index = op.kind == QueueOp::Push ? pushes : pops;
+        if (!index.emplace(op.value, &op).second)
+        {
+            fail(std::string(op.kind == QueueOp::Push ? "pushed" : "popped") + " twice: " + std::to_string(op.value));
+        }
+    }
+
+    // Popped values must have been pushed, and the push must have started first
+    for (const auto& [value, pop] : pops)
+    {
+        auto it = pushes.find(value);
+        if (it == pushes.end())
+        {
+            fail("popped a value never pushed: " + std::to_string(value));
+        }
+        else if (it->second->invoke > pop->response)
+        {
+            fail("popped before its push started: " + std::to_string(value));
+        }
+    }
+
+    // Order: if push(a) finished before push(b) started, pop(b) may not finish
+    // before pop(a) starts. Walk pushes by response time keeping the latest
+    // pop start seen so far (never-popped counts as infinitely late).
+    const uint64_t never = std::numeric_limits<uint64_t>::max();
+    std::vector<const QueueOp*> by_response;
+    for (const auto& [value, push] : pushes)
+    {
+        by_response.push_back(push);
+    }
+    std::sort(by_response.begin(), by_response.end(),
+              [](const QueueOp* a, const QueueOp* b) { return a->response < b->response; });
+
+    std::vector<uint64_t> latest_pop_start(by_response.size());
+    std::vector<long long> latest_value(by_response.size());
+    for (size_t i = 0; i < by_response.size(); ++i)
+    {
+        auto it = pops.find(by_response[i]->value);
+        uint64_t start = it == pops.end() ? never : it->second->invoke;
+        latest_pop_start[i] = start;
+        latest_value[i] = by_response[i]->value;
+        if (i > 0 && latest_pop_start[i - 1] > start)
+        {
+            latest_pop_start[i] = latest_pop_start[i - 1];
+            latest_value[i] = latest_value[i - 1];
+        }
+    }
+
+    for (const auto& [value, pop] : pops)
+    {
+        auto push = pushes.find(value);
+        if (push == pushes.end())
+        {
+            continue;
+        }
+        // Pushes that finished strictly before this push started
+        auto earlier = std::lower_bound(by_response.begin(), by_response.end(), push->second->invoke,
+                                        [](const QueueOp* op, uint64_t t) { return op->response < t; });
+        if (earlier == by_response.begin())
+        {
+            continue;
+        }
+        size_t last = (earlier - by_response.begin()) - 1;
+        if (latest_pop_start[last] > pop->response)
+        {
+            std::ostringstream out;
+            out << "FIFO order violated: " << value << " popped before earlier-pushed "
+                << latest_value[last];
+            fail(out.str());
+        }
+    }
+
+    // Capacity: completed pushes minus started pops is a lower bound on the size
+    if (capacity != 0)
+    {
+        std::vector<std::pair<uint64_t, int>> events;
+        for (const auto& op : ops)
+        {
+            if (op.kind == QueueOp::Push)
+            {
+                events.emplace_back(op.response, +1);
+            }
+            else
+            {
+                events.emplace_back(op.invoke, -1);
+            }
+        }
+        std::sort(events.begin(), events.end());
+        long long size = 0;
+        for (const auto& [tick, delta] : events)
+        {
+            size += delta;
+            if (size > static_cast<long long>(capacity))
+            {
+                fail("more than " + std::to_string(capacity) + " items held at tick " + std::to_string(tick));
+                break;
+            }
+        }
+    }
+
+    return errors;
+}
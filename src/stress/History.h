@@ -0,0 +1,59 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * One completed queue operation. invoke and response are ticks of a shared
+ * logical clock taken just before the call and just after it returned.
+ */
+struct QueueOp
+{
+    enum Kind
+    {
+        Push,
+        Pop
+    };
+
+    Kind kind;
+    long long value;
+    uint64_t invoke;
+    uint64_t response;
+};
+
+/**
+ * Collects a concurrent history. Each thread records into its own log so
+ * recording does not serialise the threads under test.
+ */
+class History
+{
+public:
+    explicit History(size_t threads);
+
+    uint64_t tick();
+    void record(size_t thread, const QueueOp& op);
+    std::vector<QueueOp> merged() const;
+
+private:
+    std::atomic<uint64_t> clock_;
+    std::vector<std::vector<QueueOp>> logs_;
+};
+
+/**
+ * Check a history of a FIFO queue holding unique values against the
+ * linearizability conditions for queues (Henzinger et al., "Aspect-oriented
+ * linearizability proofs"): values are not invented or duplicated, a push
+ * that finished before another started is also popped first, and a bounded
+ * queue never provably holds more than capacity items (0 means unbounded).
+ * Every violation found is described in the returned list.
+ */
+std::vector<std::string> check_fifo_history(const std::vector<QueueOp>& ops, size_t capacity);
+
+#endif // HISTORY_H
@@ -0,0 +1,108 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef SCHED_POINT_H
+#define SCHED_POINT_H
+
+/**
+ * Schedule perturbation points for the stress harness.
+ * In normal builds THREADING_SCHED_POINT() compiles to nothing. When built with
+ * THREADING_STRESS each point may yield or sleep, driven by a per-thread random
+ * stream derived from a global seed, so a failing run can be replayed with the
+ * same perturbation decisions.
+ */
+
+#ifdef THREADING_STRESS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace stress
+{
+    struct Settings
+    {
+        std::atomic<bool> enabled{false};
+        std::atomic<uint64_t> seed{1};
+        std::atomic<unsigned> yield_percent{10};
+        std::atomic<unsigned> sleep_percent{2};
+        std::atomic<unsigned> max_sleep_us{50};
+        std::atomic<uint64_t> next_anonymous{1u << 20};
+    };
+
+    inline Settings& settings()
+    {
+        static Settings instance;
+        return instance;
+    }
+
+    inline uint64_t splitmix64(uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    struct ThreadStream
+    {
+        bool seeded = false;
+        uint64_t state = 0;
+    };
+
+    inline ThreadStream& stream()
+    {
+        thread_local ThreadStream s;
+        return s;
+    }
+
+    /**
+     * Give the calling thread a stable identity so its random stream is the same on replay
+     */
+    inline void seed_thread(uint64_t id)
+    {
+        stream().state = splitmix64(settings().seed.load() ^ splitmix64(id));
+        stream().seeded = true;
+    }
+
+    inline void sched_point()
+    {
+        Settings& s = settings();
+        if (!s.enabled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        ThreadStream& ts = stream();
+        if (!ts.seeded)
+        {
+            // Threads nobody named get ids in order of first use
+            seed_thread(s.next_anonymous.fetch_add(1));
+        }
+        ts.state = splitmix64(ts.state);
+
+        unsigned roll = ts.state % 100;
+        if (roll < s.yield_percent)
+        {
+            std::this_thread::yield();
+        }
+        else if (roll < s.yield_percent + s.sleep_percent)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds((ts.state >> 8) % (s.max_sleep_us + 1)));
+        }
+    }
+}
+
+#define THREADING_SCHED_POINT() ::stress::sched_point()
+#define THREADING_SCHED_THREAD(id) ::stress::seed_thread(id)
+
+#else
+
+#define THREADING_SCHED_POINT() ((void)0)
+#define THREADING_SCHED_THREAD(id) ((void)0)
+
+#endif // THREADING_STRESS
+
+#endif // SCHED_POINT_H
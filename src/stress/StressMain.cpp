@@ -0,0 +1,1420 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Condition.h"
+#include "ConcurrentHashMap.h"
+#include "FileScan.h"
+#include "FlatCombining.h"
+#include "History.h"
+#include "Kernels.h"
+#include "Mutexes.h"
+#include "Pipeline.h"
+#include "Pool.h"
+#include "SchedPoint.h"
+#include "SharedRing.h"
+#include "ShardedExecutor.h"
+#include "TaskGroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Stress tests for the primitives. Every iteration runs with a different seed
+ * for the schedule perturbation points; a failure prints the seed so it can be
+ * replayed with --test NAME --seed S --iterations 1. The OS scheduler is still
+ * free to interleave differently on replay, but every yield and sleep the
+ * harness injects will be the same.
+ */
+
+namespace
+{
+    using Errors = std::vector<std::string>;
+
+    struct StressTest
+    {
+        const char* name;
+        std::function<Errors()> run;
+    };
+
+    PoolOptions quiet()
+    {
+        PoolOptions options;
+        options.verbose = false;
+        return options;
+    }
+
+    void wait_for(ThreadPool& pool, int count)
+    {
+        while (pool.get_completed_tasks() + pool.get_dropped_tasks() < count)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename Buffer>
+    Errors check_buffer_history(Buffer& buffer, size_t capacity)
+    {
+        const size_t producers = 3;
+        const size_t consumers = 3;
+        const size_t per_producer = 400;
+
+        History history(producers + consumers);
+        std::vector<std::thread> team;
+
+        for (size_t p = 0; p < producers; ++p)
+        {
+            team.emplace_back([&, p]
+            {
+                THREADING_SCHED_THREAD(p);
+                for (size_t i = 0; i < per_producer; ++i)
+                {
+                    long long value = static_cast<long long>(p) << 32 | i;
+                    uint64_t invoke = history.tick();
+                    buffer.push(value);
+                    history.record(p, {QueueOp::Push, value, invoke, history.tick()});
+                }
+            });
+        }
+        for (size_t c = 0; c < consumers; ++c)
+        {
+            team.emplace_back([&, c]
+            {
+                THREADING_SCHED_THREAD(producers + c);
+                for (size_t i = 0; i < producers * per_producer / consumers; ++i)
+                {
+                    uint64_t invoke = history.tick();
+                    long long value = buffer.pop();
+                    history.record(producers + c, {QueueOp::Pop, value, invoke, history.tick()});
+                }
+            });
+        }
+        for (auto& t : team)
+        {
+            t.join();
+        }
+
+        return check_fifo_history(history.merged(), capacity);
+    }
+
+    Errors buffer_linearizable()
+    {
+        BoundedBuffer<long long> buffer(2, false);
+        return check_buffer_history(buffer, 2);
+    }
+
+    // Pending pushes and pops matched inside one combining pass must still look like a FIFO
+    Errors combining_buffer_linearizable()
+    {
+        CombiningBuffer<long long> buffer(2);
+        return check_buffer_history(buffer, 2);
+    }
+
+    /**
+     * A one-slot buffer with consumers on the lowest record indices and
+     * producers above them, so a combiner's own pop is refused before the
+     * push that would satisfy it lands later in the same pass. When the pass
+     * cap cuts that short the combiner must retry rather than sleep: each
+     * thread has a single op, so nobody is left to publish one and wake it.
+     */
+    Errors combining_buffer_wakeup()
+    {
+        const size_t pairs = 4;
+        const int rounds = 200;
+        CombiningBuffer<long long> buffer(1);
+        std::atomic<long long> pushed{0};
+        std::atomic<long long> popped{0};
+
+        for (int round = 0; round < rounds; ++round)
+        {
+            std::vector<size_t> slots(2 * pairs);
+            std::atomic<size_t> leased{0};
+            std::vector<std::thread> team;
+            for (size_t t = 0; t < 2 * pairs; ++t)
+            {
+                team.emplace_back([&, t, round]
+                {
+                    THREADING_SCHED_THREAD(t);
+                    // Roles follow the record indices the threads were handed
+                    slots[t] = combining_detail::thread_slot();
+                    leased++;
+                    while (leased != slots.size())
+                    {
+                        std::this_thread::yield();
+                    }
+                    const auto below = std::count_if(slots.begin(), slots.end(),
+                                                     [&](size_t s) { return s < slots[t]; });
+                    if (below < static_cast<long>(pairs))
+                    {
+                        popped += buffer.pop();
+                    }
+                    else
+                    {
+                        const long long value = round * 100 + static_cast<long long>(t);
+                        buffer.push(value);
+                        pushed += value;
+                    }
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+        }
+
+        Errors errors;
+        if (pushed != popped)
+        {
+            errors.push_back("pushed " + std::to_string(pushed) + ", popped " + std::to_string(popped));
+        }
+        return errors;
+    }
+
+    Errors pool_exactly_once()
+    {
+        const int producers = 3;
+        const int per_producer = 500;
+        std::vector<std::atomic<int>> runs(producers * per_producer);
+        for (auto& r : runs)
+        {
+            r = 0;
+        }
+
+        {
+            ThreadPool pool(4, quiet());
+            std::vector<std::thread> team;
+            for (int p = 0; p < producers; ++p)
+            {
+                team.emplace_back([&, p]
+                {
+                    THREADING_SCHED_THREAD(p);
+                    for (int i = 0; i < per_producer; ++i)
+                    {
+                        int id = p * per_producer + i;
+                        pool.enqueue([&runs, id] { runs[id]++; });
+                    }
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+            wait_for(pool, producers * per_producer);
+        }
+
+        Errors errors;
+        for (size_t i = 0; i < runs.size(); ++i)
+        {
+            if (runs[i] != 1)
+            {
+                errors.push_back("task " + std::to_string(i) + " ran " + std::to_string(runs[i]) + " times");
+                break;
+            }
+        }
+        return errors;
+    }
+
+    // Tasks spawning tasks go through the worker-local buffers
+    Errors pool_nested()
+    {
+        const int depth = 10;
+        std::atomic<int> leaves{0};
+        std::atomic<int> pending{0};
+
+        {
+            PoolOptions options = quiet();
+            options.local_batching = true;
+            ThreadPool pool(4, options);
+            std::function<void(int)> spawn = [&](int level)
+            {
+                pending++;
+                pool.enqueue([&, level]
+                {
+                    THREADING_SCHED_POINT();
+                    if (level == depth)
+                    {
+                        leaves++;
+                    }
+                    else
+                    {
+                        spawn(level + 1);
+                        spawn(level + 1);
+                    }
+                    pending--;
+                });
+            };
+            spawn(0);
+            while (pending != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        Errors errors;
+        if (leaves != 1 << depth)
+        {
+            errors.push_back(std::to_string(leaves) + " leaves ran, expected " + std::to_string(1 << depth));
+        }
+        return errors;
+    }
+
+    // With default options a task may block on a child it enqueued: with a
+    // worker to spare the child must reach it rather than wait behind its parent
+    Errors pool_child_wait()
+    {
+        const int parents = 20;
+        std::atomic<int> finished{0};
+        {
+            ThreadPool pool(2, quiet());
+            for (int i = 0; i < parents; ++i)
+            {
+                // One parent at a time, so the other worker is free for its child
+                while (finished != i)
+                {
+                    std::this_thread::yield();
+                }
+                pool.enqueue([&pool, &finished]
+                {
+                    std::mutex mtx;
+                    std::condition_variable cv;
+                    bool done = false;
+                    pool.enqueue([&]
+                    {
+                        THREADING_SCHED_POINT();
+                        std::lock_guard<std::mutex> lock(mtx);
+                        done = true;
+                        cv.notify_one();
+                    });
+                    std::unique_lock<std::mutex> lock(mtx);
+                    cv.wait(lock, [&] { return done; });
+                    finished++;
+                });
+            }
+            while (finished != parents)
+            {
+                std::this_thread::yield();
+            }
+        }
+        return {};
+    }
+
+    // Fork-join where every task waits on its own children, on fewer workers
+    // than there are levels: only help-while-waiting keeps this from deadlocking
+    long join_fib(ThreadPool& pool, int n)
+    {
+        if (n < 2)
+        {
+            return n;
+        }
+        long a = 0;
+        long b = 0;
+        TaskGroup group(pool);
+        group.run([&pool, &a, n] { a = join_fib(pool, n - 1); });
+        group.run([&pool, &b, n] { b = join_fib(pool, n - 2); });
+        group.wait();
+        return a + b;
+    }
+
+    Errors task_group_join()
+    {
+        const int n = 12;
+        long result = 0;
+        {
+            PoolOptions options = quiet();
+            options.local_batching = true;
+            ThreadPool pool(2, options);
+            TaskGroup outer(pool);
+            outer.run([&pool, &result, n] { result = join_fib(pool, n); });
+            outer.wait();
+        }
+
+        Errors errors;
+        if (result != 144)
+        {
+            errors.push_back("fib(" + std::to_string(n) + ") = " + std::to_string(result) + ", expected 144");
+        }
+        return errors;
+    }
+
+    // Every index covered exactly once, from outside the pool and from inside a task
+    Errors pool_parallel_for()
+    {
+        const size_t count = 5000;
+        std::vector<std::atomic<int>> outer(count);
+        std::vector<std::atomic<int>> inner(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            outer[i] = 0;
+            inner[i] = 0;
+        }
+
+        {
+            ThreadPool pool(3, quiet());
+            pool.parallel_for_blocks(count, 7, [&](size_t begin, size_t end)
+            {
+                THREADING_SCHED_POINT();
+                for (size_t i = begin; i < end; ++i)
+                {
+                    outer[i]++;
+                }
+            });
+
+            std::atomic<bool> nested_done{false};
+            pool.enqueue([&]
+            {
+                pool.parallel_for_blocks(count, 13, [&](size_t begin, size_t end)
+                {
+                    THREADING_SCHED_POINT();
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        inner[i]++;
+                    }
+                });
+                nested_done = true;
+            });
+            while (!nested_done)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        Errors errors;
+        for (size_t i = 0; i < count && errors.empty(); ++i)
+        {
+            if (outer[i] != 1 || inner[i] != 1)
+            {
+                errors.push_back("index " + std::to_string(i) + " visited " + std::to_string(outer[i]) + "/"
+                                 + std::to_string(inner[i]) + " times");
+            }
+        }
+        return errors;
+    }
+
+    // With one worker the order tasks start in is the order they left the queue
+    Errors pool_fifo()
+    {
+        const size_t producers = 3;
+        const size_t per_producer = 300;
+        History history(producers + 1);
+
+        {
+            ThreadPool pool(1, quiet());
+            std::vector<std::thread> team;
+            for (size_t p = 0; p < producers; ++p)
+            {
+                team.emplace_back([&, p]
+                {
+                    THREADING_SCHED_THREAD(p);
+                    for (size_t i = 0; i < per_producer; ++i)
+                    {
+                        long long value = static_cast<long long>(p) << 32 | i;
+                        uint64_t invoke = history.tick();
+                        pool.enqueue([&history, value, producers]
+                        {
+                            uint64_t now = history.tick();
+                            history.record(producers, {QueueOp::Pop, value, now, now});
+                        });
+                        history.record(p, {QueueOp::Push, value, invoke, history.tick()});
+                    }
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+            wait_for(pool, producers * per_producer);
+        }
+
+        return check_fifo_history(history.merged(), 0);
+    }
+
+    Errors pool_overflow()
+    {
+        Errors errors;
+        const int submitted = 400;
+        const size_t capacity = 4;
+
+        for (auto policy : {OverflowPolicy::Block, OverflowPolicy::Reject,
+                            OverflowPolicy::DropOldest, OverflowPolicy::CallerRuns})
+        {
+            PoolOptions options = quiet();
+            options.capacity = capacity;
+            options.overflow = policy;
+            std::atomic<int> ran{0};
+            int accepted = 0;
+            int dropped = 0;
+            int rejected = 0;
+            int max_pending = 0;
+            {
+                ThreadPool pool(2, options);
+                for (int i = 0; i < submitted; ++i)
+                {
+                    if (pool.enqueue([&ran] { ran++; }))
+                    {
+                        accepted++;
+                    }
+                    max_pending = std::max(max_pending, pool.get_pending_tasks());
+                }
+                // Rejected tasks never reach the queue, so wait only for the rest
+                while (pool.get_completed_tasks() + pool.get_dropped_tasks() < accepted)
+                {
+                    std::this_thread::yield();
+                }
+                dropped = pool.get_dropped_tasks();
+                rejected = pool.get_rejected_tasks();
+            }
+
+            std::string name = "policy " + std::to_string(static_cast<int>(policy)) + ": ";
+            if (max_pending > static_cast<int>(capacity))
+            {
+                errors.push_back(name + "queue grew to " + std::to_string(max_pending));
+            }
+            if (ran + dropped + rejected != submitted)
+            {
+                errors.push_back(name + std::to_string(ran) + " ran + " + std::to_string(dropped) + " dropped + "
+                                 + std::to_string(rejected) + " rejected != " + std::to_string(submitted));
+            }
+            if ((policy == OverflowPolicy::Block || policy == OverflowPolicy::CallerRuns) && ran != submitted)
+            {
+                errors.push_back(name + "lost tasks");
+            }
+        }
+        return errors;
+    }
+
+    /**
+     * The overflow policies and nested submission again on a pool with a
+     * four-slot ring, spinning workers, move-only inline tasks and no stats,
+     * counting runs by hand
+     */
+    Errors pool_policies()
+    {
+        using RingPool = BasicThreadPool<RingQueue<4>, SpinWait, InplaceTask<>, NoStats>;
+        Errors errors;
+        const int submitted = 400;
+
+        for (auto policy : {OverflowPolicy::Block, OverflowPolicy::Reject,
+                            OverflowPolicy::DropOldest, OverflowPolicy::CallerRuns})
+        {
+            PoolOptions options = quiet();
+            options.overflow = policy;
+            std::atomic<int> ran{0};
+            int accepted = 0;
+            int dropped = 0;
+            int rejected = 0;
+            int max_pending = 0;
+            {
+                RingPool pool(2, options);
+                for (int i = 0; i < submitted; ++i)
+                {
+                    auto token = std::make_unique<int>(i);
+                    if (pool.enqueue([&ran, token = std::move(token)] { ran += *token >= 0; }))
+                    {
+                        accepted++;
+                    }
+                    max_pending = std::max(max_pending, pool.get_pending_tasks());
+                }
+                while (ran + pool.get_dropped_tasks() < accepted)
+                {
+                    std::this_thread::yield();
+                }
+                dropped = pool.get_dropped_tasks();
+                rejected = pool.get_rejected_tasks();
+            }
+
+            std::string name = "policy " + std::to_string(static_cast<int>(policy)) + ": ";
+            if (max_pending > 4)
+            {
+                errors.push_back(name + "ring held " + std::to_string(max_pending));
+            }
+            if (ran + dropped + rejected != submitted)
+            {
+                errors.push_back(name + std::to_string(ran) + " ran + " + std::to_string(dropped) + " dropped + "
+                                 + std::to_string(rejected) + " rejected != " + std::to_string(submitted));
+            }
+            if ((policy == OverflowPolicy::Block || policy == OverflowPolicy::CallerRuns) && ran != submitted)
+            {
+                errors.push_back(name + "lost tasks");
+            }
+        }
+
+        // Worker-local batches larger than the ring: the hand-off takes what fits
+        const int depth = 8;
+        std::atomic<int> leaves{0};
+        std::atomic<int> pending{0};
+        {
+            PoolOptions options = quiet();
+            options.local_batching = true;
+            RingPool pool(3, options);
+            std::function<void(int)> spawn = [&](int level)
+            {
+                pending++;
+                pool.enqueue([&, level]
+                {
+                    THREADING_SCHED_POINT();
+                    for (int child = 0; level < depth && child < 4; ++child)
+                    {
+                        spawn(level + 2);
+                    }
+                    leaves += level >= depth;
+                    pending--;
+                });
+            };
+            spawn(0);
+            while (pending != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        if (leaves != 1 << depth)
+        {
+            errors.push_back("nested: " + std::to_string(leaves) + " leaves ran, expected "
+                             + std::to_string(1 << depth));
+        }
+        return errors;
+    }
+
+    /**
+     * Tasks, nested tasks, CallerRuns overflow on several producers and
+     * parallel_for_blocks from two outside threads at once all count into
+     * worker-local partials, each with a read and write far enough apart to
+     * lose updates if two threads shared one. The folded total must match
+     * and no two threads may have been handed the same instance.
+     */
+    Errors worker_local_partials()
+    {
+        const size_t producers = 3;
+        const int per_producer = 200;
+        const size_t callers = 2;
+        const size_t count = 3000;
+        struct Count;
+        long total = 0;
+        std::vector<const long*> instances;
+
+        {
+            PoolOptions options = quiet();
+            options.capacity = 2;
+            options.overflow = OverflowPolicy::CallerRuns;
+            ThreadPool pool(3, options);
+            auto add = [&pool](long n)
+            {
+                long& mine = pool.worker_local<long, Count>();
+                const long seen = mine;
+                THREADING_SCHED_POINT();
+                mine = seen + n;
+            };
+
+            TaskGroup group(pool);
+            std::vector<std::thread> team;
+            for (size_t p = 0; p < producers; ++p)
+            {
+                team.emplace_back([&, p]
+                {
+                    THREADING_SCHED_THREAD(p);
+                    for (int i = 0; i < per_producer; ++i)
+                    {
+                        group.run([&add, &group, i]
+                        {
+                            add(1);
+                            if (i % 4 == 0)
+                            {
+                                group.run([&add] { add(1); });
+                            }
+                        });
+                    }
+                });
+            }
+            for (size_t c = 0; c < callers; ++c)
+            {
+                team.emplace_back([&, c]
+                {
+                    THREADING_SCHED_THREAD(producers + c);
+                    pool.parallel_for_blocks(count, 7, [&add](size_t begin, size_t end)
+                    {
+                        add(static_cast<long>(end - begin));
+                    });
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+            group.wait();
+            pool.combine_worker_locals<long, Count>([&](long& partial)
+            {
+                total += partial;
+                instances.push_back(&partial);
+            });
+        }
+
+        Errors errors;
+        const long expected = producers * (per_producer + per_producer / 4) + callers * count;
+        if (total != expected)
+        {
+            errors.push_back("partials add up to " + std::to_string(total) + ", expected " + std::to_string(expected));
+        }
+        std::sort(instances.begin(), instances.end());
+        if (std::adjacent_find(instances.begin(), instances.end()) != instances.end())
+        {
+            errors.push_back("two threads share an instance");
+        }
+        return errors;
+    }
+
+    // Two producer processes share a small ring, one dies halfway through
+    // writing an item and a consumer process dies halfway through reading one.
+    // Everything else must arrive once, in order per producer.
+    Errors shared_ring_recovery()
+    {
+        using Ring = SharedRing<int>;
+        static int run = 0;
+        const std::string name = "/threading_stress_ring_" + std::to_string(getpid()) + "_" + std::to_string(run++);
+        const int per_producer = 50;
+
+        Errors errors;
+        auto ring = Ring::create(name, 4, Ring::Role::Consumer);
+        if (!ring)
+        {
+            errors.push_back("cannot create shared memory ring " + name);
+            return errors;
+        }
+
+        std::vector<pid_t> children;
+        for (int producer = 0; producer < 2; ++producer)
+        {
+            pid_t child = fork();
+            if (child == 0)
+            {
+                auto out = Ring::open(name, Ring::Role::Producer);
+                for (int i = 0; out && i < per_producer; ++i)
+                {
+                    out->push(producer * 1000 + i);
+                }
+                if (out && producer == 0)
+                {
+                    out->produce([](int&) { _exit(1); });
+                }
+                _exit(0);
+            }
+            children.push_back(child);
+        }
+
+        // Takes one item and dies before releasing it
+        pid_t reader = fork();
+        if (reader == 0)
+        {
+            auto in = Ring::open(name, Ring::Role::Consumer);
+            if (in)
+            {
+                in->consume([](const int&) { _exit(1); });
+            }
+            _exit(0);
+        }
+        children.push_back(reader);
+
+        // Once every child is gone, a sentinel behind the crashed write ends the stream
+        std::thread closer([&]
+        {
+            for (pid_t child : children)
+            {
+                waitpid(child, nullptr, 0);
+            }
+            ring->push(-1);
+        });
+
+        std::vector<int> next(2, 0);
+        int received = 0;
+        for (int value = ring->pop(); value != -1; value = ring->pop())
+        {
+            int producer = value / 1000;
+            int seq = value % 1000;
+            if (producer > 1 || seq < next[producer])
+            {
+                errors.push_back("unexpected or repeated item " + std::to_string(value));
+            }
+            else
+            {
+                next[producer] = seq + 1;
+            }
+            received++;
+        }
+        closer.join();
+
+        // The dead reader may have swallowed one item, nothing else goes missing
+        const int lost = 2 * per_producer - received;
+        if (lost < 0 || lost > 1)
+        {
+            errors.push_back("received " + std::to_string(received) + " of " + std::to_string(2 * per_producer)
+                + " items, only the crashed reader's one may be lost");
+        }
+        if (ring->size() != 0)
+        {
+            errors.push_back(std::to_string(ring->size()) + " items left after the sentinel");
+        }
+
+        ring.reset();
+        Ring::unlink(name);
+        return errors;
+    }
+
+    template <typename Counter>
+    Errors counter_total()
+    {
+        Errors errors;
+        Counter counter;
+        std::atomic<bool> done{false};
+        std::atomic<bool> went_backwards{false};
+        std::vector<std::thread> team;
+
+        for (int t = 0; t < 4; ++t)
+        {
+            team.emplace_back([&, t]
+            {
+                THREADING_SCHED_THREAD(t);
+                for (int i = 0; i < 2000; ++i)
+                {
+                    counter.increment();
+                }
+            });
+        }
+        // Only increments are running, so a reader must never see the value drop
+        std::thread reader([&]
+        {
+            THREADING_SCHED_THREAD(100);
+            int last = 0;
+            while (!done)
+            {
+                int now = counter.get();
+                if (now < last)
+                {
+                    went_backwards = true;
+                }
+                last = now;
+            }
+        });
+        for (auto& t : team)
+        {
+            t.join();
+        }
+        done = true;
+        reader.join();
+
+        if (went_backwards)
+        {
+            errors.push_back("counter value went backwards");
+        }
+
+        team.clear();
+        for (int t = 0; t < 4; ++t)
+        {
+            team.emplace_back([&, t]
+            {
+                THREADING_SCHED_THREAD(200 + t);
+                for (int i = 0; i < 1000; ++i)
+                {
+                    if (t % 2 == 0)
+                    {
+                        counter.decrement();
+                    }
+                    else
+                    {
+                        counter.increment();
+                    }
+                }
+            });
+        }
+        for (auto& t : team)
+        {
+            t.join();
+        }
+
+        if (counter.get() != 8000)
+        {
+            errors.push_back("final counter " + std::to_string(counter.get()) + ", expected 8000");
+        }
+        return errors;
+    }
+
+    // Few shards and a tiny start so resizes and migrations happen mid-traffic
+    Errors hashmap_counts()
+    {
+        const int threads = 4;
+        const int ops = 4000;
+        ConcurrentHashMap<int, long> map(2, 8);
+        std::vector<std::thread> team;
+
+        for (int t = 0; t < threads; ++t)
+        {
+            team.emplace_back([&, t]
+            {
+                THREADING_SCHED_THREAD(t);
+                for (int i = 0; i < ops; ++i)
+                {
+                    THREADING_SCHED_POINT();
+                    map.fetch_add(i % 300, 1);
+                    // Private keys: insert all, then erase the odd ones
+                    int mine = 100000 * (t + 1) + i;
+                    map.insert(mine, i);
+                    if (i % 2 == 1)
+                    {
+                        map.erase(mine);
+                    }
+                }
+            });
+        }
+        for (auto& t : team)
+        {
+            t.join();
+        }
+
+        Errors errors;
+        for (int k = 0; k < 300 && errors.empty(); ++k)
+        {
+            long want = threads * (ops / 300 + (k < ops % 300 ? 1 : 0));
+            long got = map.find(k).value_or(-1);
+            if (got != want)
+            {
+                errors.push_back("key " + std::to_string(k) + " = " + std::to_string(got) + ", expected "
+                                 + std::to_string(want));
+            }
+        }
+        for (int t = 0; t < threads && errors.empty(); ++t)
+        {
+            for (int i = 0; i < ops; ++i)
+            {
+                auto value = map.find(100000 * (t + 1) + i);
+                if (i % 2 == 0 ? value != std::optional<long>(i) : value.has_value())
+                {
+                    errors.push_back("private key " + std::to_string(i) + " of thread " + std::to_string(t) + " wrong");
+                    break;
+                }
+            }
+        }
+        size_t want_size = 300 + threads * ops / 2;
+        if (map.size() != want_size)
+        {
+            errors.push_back("size " + std::to_string(map.size()) + ", expected " + std::to_string(want_size));
+        }
+        return errors;
+    }
+
+    // One shard, 800 keys into 1024 slots: the resize fires near the end of the inserts, so the erases
+    // below start with most of the old table still to migrate and hit keys from both tables
+    Errors hashmap_erase_migrated()
+    {
+        const int threads = 4;
+        const int per_thread = 200;
+        ConcurrentHashMap<int, std::string> map(1, 1024);
+        std::vector<std::thread> team;
+        std::atomic<int> wrong{0};
+
+        auto phase = [&](auto body)
+        {
+            team.clear();
+            for (int t = 0; t < threads; ++t)
+            {
+                team.emplace_back([&, t]
+                {
+                    THREADING_SCHED_THREAD(t);
+                    for (int i = 0; i < per_thread; ++i)
+                    {
+                        THREADING_SCHED_POINT();
+                        body(t * per_thread + i);
+                    }
+                });
+            }
+            for (auto& t : team)
+            {
+                t.join();
+            }
+        };
+        auto count_visited = [&map]
+        {
+            size_t visited = 0;
+            map.for_each([&visited](const int&, const std::string&) { visited++; });
+            return visited;
+        };
+
+        Errors errors;
+        phase([&map](int key) { map.insert(key, std::to_string(key)); });
+        const size_t total = threads * per_thread;
+        if (map.size() != total || count_visited() != total)
+        {
+            errors.push_back("after inserts size " + std::to_string(map.size()) + ", for_each "
+                             + std::to_string(count_visited()) + ", expected " + std::to_string(total));
+        }
+
+        // Erase the even keys, each must be gone at once and its odd neighbour untouched
+        phase([&map, &wrong](int key)
+        {
+            if (key % 2 != 0)
+            {
+                return;
+            }
+            if (!map.erase(key) || map.find(key).has_value() || map.find(key + 1) != std::to_string(key + 1))
+            {
+                wrong++;
+            }
+        });
+        if (wrong.load() != 0)
+        {
+            errors.push_back(std::to_string(wrong.load()) + " erases left the key behind or disturbed a neighbour");
+        }
+
+        for (int key = 0; key < static_cast<int>(total) && errors.empty(); ++key)
+        {
+            auto value = map.find(key);
+            if (key % 2 == 0 ? value.has_value() : value != std::to_string(key))
+            {
+                errors.push_back("key " + std::to_string(key) + " wrong after erase, value '" + value.value_or("<none>")
+                                 + "'");
+            }
+        }
+        if (map.size() != total / 2 || count_visited() != total / 2)
+        {
+            errors.push_back("after erases size " + std::to_string(map.size()) + ", for_each "
+                             + std::to_string(count_visited()) + ", expected " + std::to_string(total / 2));
+        }
+        return errors;
+    }
+
+    // Every vector kernel this CPU runs against the plain % loop: empty and short ranges, tails of every
+    // length, ranges ending at UINT32_MAX, and divisors from 1 up past 2^31 where lanes flush every vector
+    Errors simd_mod_sum()
+    {
+        const uint32_t divisors[] = {1, 2, 3, 7, 16, 107, 1024, 65535, 65536, 1u << 31, (1u << 31) + 1,
+                                     3000000019u, UINT32_MAX};
+        std::vector<std::pair<uint32_t, uint32_t>> ranges = {{0, 0}, {5, 5}, {0, 1}, {0, 4096},
+                                                             {UINT32_MAX - 5000, UINT32_MAX}};
+        for (uint32_t length = 1; length <= 67; length += 3)
+        {
+            ranges.emplace_back(3, 3 + length);
+            ranges.emplace_back(UINT32_MAX - length, UINT32_MAX);
+        }
+
+        Errors errors;
+        for (auto level : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512})
+        {
+            if (!simd_supported(level))
+            {
+                continue;
+            }
+            ModSumKernel kernel = mod_sum_kernel(level);
+            for (uint32_t d : divisors)
+            {
+                for (auto [begin, end] : ranges)
+                {
+                    uint64_t want = mod_sum_naive(begin, end, d);
+                    uint64_t got = kernel(begin, end, Divisor(d));
+                    if (got != want && errors.size() < 5)
+                    {
+                        errors.push_back(std::string(simd_name(level)) + " [" + std::to_string(begin) + ", "
+                                         + std::to_string(end) + ") % " + std::to_string(d) + " = "
+                                         + std::to_string(got) + ", expected " + std::to_string(want));
+                    }
+                }
+            }
+        }
+
+        // The batch on a pool, with the divisors above that fit in an int
+        ThreadPool pool(3, quiet());
+        std::vector<int> values = {1, 2, 3, 7, 16, 107, 1024, 65535, 65536, INT32_MAX, -1, -7};
+        const uint32_t iterations = 1000;
+        std::vector<uint64_t> results = compute_batch(pool, values, iterations, 5);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            uint64_t want = mod_sum_naive(0, iterations, static_cast<uint32_t>(values[i]));
+            if (results[i] != want)
+            {
+                errors.push_back("compute_batch value " + std::to_string(values[i]) + " = "
+                                 + std::to_string(results[i]) + ", expected " + std::to_string(want));
+            }
+        }
+
+        auto rejects_zero = [](auto fn)
+        {
+            try
+            {
+                fn();
+            }
+            catch (const std::invalid_argument&)
+            {
+                return true;
+            }
+            return false;
+        };
+        if (!rejects_zero([] { Divisor zero(0); }))
+        {
+            errors.push_back("Divisor(0) did not throw std::invalid_argument");
+        }
+        if (!rejects_zero([&pool] { compute_batch(pool, {4, 0, 9}, 10); }))
+        {
+            errors.push_back("compute_batch with a 0 value did not throw std::invalid_argument");
+        }
+        return errors;
+    }
+
+    Errors sharded_messages()
+    {
+        const size_t cores = 4;
+        const int per_pair = 300;
+
+        // Each core remembers the last sequence number it got from every sender
+        struct Received
+        {
+            std::vector<int> next = std::vector<int>(cores + 1, 0);
+            int total = 0;
+            bool reordered = false;
+        };
+
+        // Tiny mailboxes and a short spin so the overflow and sleep paths both run
+        ReactorOptions options;
+        options.pin_threads = false;
+        options.mailbox_capacity = 2;
+        options.spin_rounds = 10;
+        options.yield_rounds = 2;
+        ShardedExecutor<Received> executor(cores, options);
+
+        auto deliver = [](size_t from, int seq)
+        {
+            return [from, seq](Received& r)
+            {
+                r.reordered |= r.next[from] != seq;
+                r.next[from] = seq + 1;
+                r.total++;
+            };
+        };
+        for (size_t core = 0; core < cores; ++core)
+        {
+            executor.submit_to(core, [&executor, &deliver, core](Received&)
+            {
+                for (int seq = 0; seq < per_pair; ++seq)
+                {
+                    for (size_t to = 0; to < cores; ++to)
+                    {
+                        executor.submit_to(to, deliver(core, seq));
+                    }
+                }
+            });
+        }
+        // Outside threads go through the locked inboxes instead
+        std::thread outside([&]
+        {
+            THREADING_SCHED_THREAD(50);
+            for (int seq = 0; seq < per_pair; ++seq)
+            {
+                executor.submit_to(seq % cores, [seq](Received& r) { r.total++; });
+            }
+        });
+        outside.join();
+        executor.wait_idle();
+
+        Errors errors;
+        const int expected = static_cast<int>(cores * cores) * per_pair + per_pair;
+        int total = executor.map_reduce_across_cores([](Received& r) { return r.total; }, 0,
+                                                     [](int a, int b) { return a + b; });
+        if (total != expected)
+        {
+            errors.push_back("delivered " + std::to_string(total) + " messages, expected " + std::to_string(expected));
+        }
+        bool reordered = executor.map_reduce_across_cores([](Received& r) { return r.reordered; }, false,
+                                                          [](bool a, bool b) { return a || b; });
+        if (reordered)
+        {
+            errors.push_back("messages from one core arrived out of order");
+        }
+        return errors;
+    }
+
+    Errors file_scan_chunks()
+    {
+        // Lines from 1 to 120 bytes against 16-byte chunks: many lines straddle
+        // a boundary, some cover several, and the last has no newline
+        const int lines = 2000;
+        const std::string path = (std::filesystem::temp_directory_path()
+            / ("threading_stress_scan_" + std::to_string(getpid()) + ".log")).string();
+        long long expected = 0;
+        {
+            std::ofstream out(path, std::ios::binary);
+            for (int i = 1; i <= lines; ++i)
+            {
+                out << i << std::string(static_cast<size_t>(i * 37 % 118), 'x');
+                if (i != lines)
+                {
+                    out << '\n';
+                }
+                expected += i;
+            }
+        }
+
+        struct Totals
+        {
+            long long lines = 0;
+            long long sum = 0;
+        };
+        auto count = [](std::string_view chunk)
+        {
+            THREADING_SCHED_POINT();
+            Totals totals;
+            for (size_t pos = 0; pos < chunk.size();)
+            {
+                size_t end = std::min(chunk.find('\n', pos), chunk.size());
+                totals.lines++;
+                totals.sum += std::atoll(std::string(chunk.substr(pos, end - pos)).c_str());
+                pos = end + 1;
+            }
+            return totals;
+        };
+        auto merge = [](Totals a, Totals b) { return Totals{a.lines + b.lines, a.sum + b.sum}; };
+
+        FileScanOptions options;
+        options.chunk_bytes = 16;
+        ThreadPool pool(3, quiet());
+        auto totals = parallel_file_scan(pool, path, count, merge, Totals{}, options);
+        std::remove(path.c_str());
+
+        Errors errors;
+        if (!totals)
+        {
+            errors.push_back("could not map " + path);
+        }
+        else if (totals->lines != lines || totals->sum != expected)
+        {
+            errors.push_back("scanned " + std::to_string(totals->lines) + " lines summing to "
+                + std::to_string(totals->sum) + ", expected " + std::to_string(lines) + " summing to "
+                + std::to_string(expected));
+        }
+        return errors;
+    }
+
+    Errors pipeline_order()
+    {
+        Errors errors;
+        const int items = 3000;
+        ThreadPool pool(3, quiet());
+        int expect = 0;
+        std::atomic<long long> sum{0};
+
+        {
+            auto chain = make_pipeline<int>(pool)
+                .stage(StageOptions::parallel("filter", 3, 8), [](int v) -> std::optional<int>
+                {
+                    THREADING_SCHED_POINT();
+                    return v % 3 == 0 ? std::nullopt : std::optional<int>(v);
+                })
+                .stage(StageOptions::parallel("double", 3, 4), [](int v)
+                {
+                    THREADING_SCHED_POINT();
+                    return 2 * v;
+                })
+                .stage(StageOptions::serial_in_order("check", 8), [&](int v)
+                {
+                    // Skip the values the filter removed, everything else must arrive in order
+                    while (expect % 3 == 0)
+                    {
+                        expect++;
+                    }
+                    if (v != 2 * expect && errors.size() < 5)
+                    {
+                        errors.push_back("in-order stage saw " + std::to_string(v) + ", expected "
+                                         + std::to_string(2 * expect));
+                    }
+                    expect++;
+                    return v;
+                })
+                .sink(StageOptions::parallel("sum", 2, 16), [&sum](int v) { sum += v; });
+
+            for (int i = 0; i < items; ++i)
+            {
+                chain.push(i);
+            }
+            chain.wait();
+        }
+
+        long long want = 0;
+        for (int i = 0; i < items; ++i)
+        {
+            want += i % 3 == 0 ? 0 : 2 * i;
+        }
+        if (sum != want)
+        {
+            errors.push_back("pipeline sum " + std::to_string(sum.load()) + ", expected " + std::to_string(want));
+        }
+        return errors;
+    }
+
+    void usage()
+    {
+        std::cout << "usage: threading_stress [options]\n"
+            << "  --test NAME         run only this test (default all)\n"
+            << "  --seed S            first schedule seed (default 1)\n"
+            << "  --iterations N      seeds per test (default 20)\n"
+            << "  --yield PCT         chance a schedule point yields (default 10)\n"
+            << "  --sleep PCT         chance a schedule point sleeps (default 2)\n"
+            << "  --timeout SECONDS   per-test limit before reporting a deadlock (default 60)\n";
+    }
+
+    // The whole of text as a number from min to max; std::stoull alone accepts "5x" and "-1"
+    uint64_t parse_number(const std::string& text, uint64_t min, uint64_t max)
+    {
+        size_t used = 0;
+        uint64_t value = text.empty() || text[0] == '-' ? 0 : std::stoull(text, &used);
+        if (used == 0 || used != text.size() || value < min || value > max)
+        {
+            throw std::invalid_argument(text);
+        }
+        return value;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string only;
+    uint64_t first_seed = 1;
+    int iterations = 20;
+    int timeout_seconds = 60;
+    auto& settings = stress::settings();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << arg << " needs a value" << std::endl;
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        try
+        {
+            if (arg == "--test") only = next();
+            else if (arg == "--seed") first_seed = parse_number(next(), 0, UINT64_MAX);
+            else if (arg == "--iterations") iterations = static_cast<int>(parse_number(next(), 1, INT32_MAX));
+            else if (arg == "--yield") settings.yield_percent = static_cast<unsigned>(parse_number(next(), 0, 100));
+            else if (arg == "--sleep") settings.sleep_percent = static_cast<unsigned>(parse_number(next(), 0, 100));
+            else if (arg == "--timeout") timeout_seconds = static_cast<int>(parse_number(next(), 1, INT32_MAX));
+            else
+            {
+                usage();
+                return arg == "--help" ? 0 : 2;
+            }
+        }
+        catch (const std::exception&)
+        {
+            std::cerr << "bad value for " << arg << ": " << argv[i] << std::endl;
+            usage();
+            return 2;
+        }
+    }
+
+    const StressTest tests[] = {
+        {"buffer_linearizable", buffer_linearizable},
+        {"combining_buffer_linearizable", combining_buffer_linearizable},
+        {"combining_buffer_wakeup", combining_buffer_wakeup},
+        {"pool_exactly_once", pool_exactly_once},
+        {"pool_nested", pool_nested},
+        {"pool_child_wait", pool_child_wait},
+        {"task_group_join", task_group_join},
+        {"pool_parallel_for", pool_parallel_for},
+        {"pool_fifo", pool_fifo},
+        {"pool_overflow", pool_overflow},
+        {"pool_policies", pool_policies},
+        {"worker_local_partials", worker_local_partials},
+        {"shared_ring_recovery", shared_ring_recovery},
+        {"counter_total", counter_total<ThreadSafeCounter>},
+        {"combining_counter_total", counter_total<CombiningCounter>},
+        {"hashmap_counts", hashmap_counts},
+        {"hashmap_erase_migrated", hashmap_erase_migrated},
+        {"simd_mod_sum", simd_mod_sum},
+        {"sharded_messages", sharded_messages},
+        {"file_scan_chunks", file_scan_chunks},
+        {"pipeline_order", pipeline_order},
+    };
+
+    // A deadlock shows up as an iteration that never finishes
+    std::atomic<long long> heartbeat{0};
+    std::atomic<const char*> current_test{""};
+    std::atomic<uint64_t> current_seed{0};
+    std::thread watchdog([&]
+    {
+        long long last = -1;
+        int stuck = 0;
+        while (true)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            long long now = heartbeat.load();
+            stuck = now == last ? stuck + 1 : 0;
+            last = now;
+            if (stuck >= timeout_seconds)
+            {
+                std::cerr << "TIMEOUT " << current_test.load() << " (possible deadlock), replay with --test "
+                    << current_test.load() << " --seed " << current_seed.load() << " --iterations 1" << std::endl;
+                std::_Exit(1);
+            }
+        }
+    });
+    watchdog.detach();
+
+    int failures = 0;
+    for (const auto& test : tests)
+    {
+        if (!only.empty() && only != test.name)
+        {
+            continue;
+        }
+
+        int passed = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            uint64_t seed = first_seed + i;
+            current_test = test.name;
+            current_seed = seed;
+
+            settings.seed = seed;
+            settings.next_anonymous = 1u << 20;
+            settings.enabled = true;
+            THREADING_SCHED_THREAD(999);
+            Errors errors = test.run();
+            settings.enabled = false;
+            heartbeat++;
+
+            if (errors.empty())
+            {
+                passed++;
+                continue;
+            }
+            failures++;
+            std::cout << "FAIL " << test.name << " seed " << seed << std::endl;
+            for (const auto& e : errors)
+            {
+                std::cout << "    " << e << std::endl;
+            }
+            std::cout << "    replay: threading_stress --test " << test.name << " --seed " << seed
+                << " --iterations 1" << std::endl;
+        }
+        std::cout << (passed == iterations ? "ok   " : "FAIL ") << test.name << " "
+            << passed << "/" << iterations << " seeds passed" << std::endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,369 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#include "Tuning.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <sched.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Remember the tightest limit seen, 0 meaning unlimited
+    void tighten(double& limit, double cpus)
+    {
+        if (cpus > 0 && (limit == 0 || cpus < limit))
+        {
+            limit = cpus;
+        }
+    }
+
+    // cgroup v2: "max 100000" or "<quota> <period>"
+    double read_cpu_max(const std::string& dir)
+    {
+        std::ifstream in(dir + "/cpu.max");
+        std::string quota;
+        double period = 0;
+        if (!(in >> quota >> period) || quota == "max" || period <= 0)
+        {
+            return 0;
+        }
+        return std::atof(quota.c_str()) / period;
+    }
+
+    // cgroup v1: cpu.cfs_quota_us is -1 when unlimited
+    double read_cfs_quota(const std::string& dir)
+    {
+        std::ifstream quota_in(dir + "/cpu.cfs_quota_us");
+        std::ifstream period_in(dir + "/cpu.cfs_period_us");
+        double quota = 0;
+        double period = 0;
+        if (!(quota_in >> quota) || !(period_in >> period) || quota <= 0 || period <= 0)
+        {
+            return 0;
+        }
+        return quota / period;
+    }
+
+    // A parent's limit also caps its children, so check every level up to the mount
+    void walk_cgroup(const std::string& mount, std::string path, double (*read)(const std::string&), double& limit)
+    {
+        while (true)
+        {
+            tighten(limit, read(mount + path));
+            if (path.empty())
+            {
+                return;
+            }
+            path.erase(path.find_last_of('/'));
+        }
+    }
+
+    bool has_controller(const std::string& list, const char* name)
+    {
+        std::stringstream controllers(list);
+        std::string controller;
+        while (std::getline(controllers, controller, ','))
+        {
+            if (controller == name)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    double cgroup_cpu_limit()
+    {
+        double limit = 0;
+        std::ifstream in("/proc/self/cgroup");
+        std::string line;
+        while (std::getline(in, line))
+        {
+            // hierarchy-id:controllers:path, controllers empty for the v2 hierarchy
+            size_t first = line.find(':');
+            size_t second = line.find(':', first + 1);
+            if (first == std::string::npos || second == std::string::npos)
+            {
+                continue;
+            }
+            std::string controllers = line.substr(first + 1, second - first - 1);
+            std::string path = line.substr(second + 1);
+            if (path == "/")
+            {
+                path.clear();
+            }
+
+            if (controllers.empty())
+            {
+                // Pure v2 mounts at the root, hybrid systems under unified/
+                for (const char* mount : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"})
+                {
+                    walk_cgroup(mount, path, read_cpu_max, limit);
+                }
+            }
+            else if (has_controller(controllers, "cpu"))
+            {
+                for (const char* mount : {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct"})
+                {
+                    walk_cgroup(mount, path, read_cfs_quota, limit);
+                }
+            }
+        }
+        return limit;
+    }
+
+    const char* workload_name(Workload workload)
+    {
+        return workload == Workload::Compute ? "compute" : "mixed";
+    }
+}
+
+CpuTopology probe_topology()
+{
+    CpuTopology topology;
+    std::set<std::string> cores;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &set))
+            {
+                continue;
+            }
+            topology.logical++;
+            // SMT siblings share one list, so each distinct list is a core
+            std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+            std::string siblings;
+            cores.insert(std::getline(in, siblings) ? siblings : "cpu" + std::to_string(cpu));
+        }
+    }
+    if (topology.logical == 0)
+    {
+        topology.logical = std::max(1u, std::thread::hardware_concurrency());
+        topology.cores = topology.logical;
+    }
+    else
+    {
+        topology.cores = static_cast<unsigned>(cores.size());
+    }
+    topology.quota = cgroup_cpu_limit();
+    return topology;
+}
+
+Calibration calibrate()
+{
+    Calibration calibration;
+
+    const int spins = 20000;
+    double best = 0;
+    for (int round = 0; round < 3; ++round)
+    {
+        auto start = Clock::now();
+        for (int i = 0; i < spins; ++i)
+        {
+            cpu_relax();
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / spins;
+        best = round == 0 ? ns : std::min(best, ns);
+    }
+    calibration.spin_ns = best;
+
+    // Wake-up cost of a worker asleep on the condition variable
+    PoolOptions options;
+    options.verbose = false;
+    ThreadPool pool(1, options);
+    std::vector<double> handoffs;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        std::atomic<long long> started{0};
+        auto submitted = Clock::now();
+        pool.enqueue([&started]
+        {
+            started = Clock::now().time_since_epoch().count();
+        });
+        while (started.load() == 0)
+        {
+            std::this_thread::yield();
+        }
+        auto began = Clock::time_point(Clock::duration(started.load()));
+        handoffs.push_back(std::chrono::duration<double, std::nano>(began - submitted).count());
+    }
+    std::nth_element(handoffs.begin(), handoffs.begin() + handoffs.size() / 2, handoffs.end());
+    calibration.handoff_ns = handoffs[handoffs.size() / 2];
+    return calibration;
+}
+
+PoolOptions TuningProfile::pool_options() const
+{
+    PoolOptions options;
+    options.spin_iterations = spin_iterations;
+    return options;
+}
+
+TuningOptions TuningOptions::from_environment()
+{
+    TuningOptions options;
+    const char* path = std::getenv("THREADING_TUNING_PROFILE");
+    if (path && *path && std::strcmp(path, "off") != 0)
+    {
+        options.profile_path = path;
+    }
+    const char* calibrate = std::getenv("THREADING_CALIBRATE");
+    options.calibrate = !calibrate || std::strcmp(calibrate, "0") != 0;
+    return options;
+}
+
+void choose_settings(TuningProfile& profile)
+{
+    const CpuTopology& topology = profile.topology;
+    unsigned usable = std::max(1u, topology.logical);
+    if (profile.workload == Workload::Compute)
+    {
+        usable = std::min(usable, std::max(1u, topology.cores));
+    }
+    if (topology.quota > 0)
+    {
+        // A compute pool over its quota just gets throttled, round down; mixed work rounds up
+        double cpus = profile.workload == Workload::Compute ? std::floor(topology.quota) : std::ceil(topology.quota);
+        usable = std::min(usable, std::max(1u, static_cast<unsigned>(cpus)));
+    }
+    profile.threads = usable;
+
+    // Spin for about as long as a sleep and wake-up would cost, which at worst
+    // doubles the wait. On a single CPU spinning only delays whoever would
+    // submit the work, so never spin there.
+    const double cpus = topology.quota > 0 ? std::min<double>(topology.logical, topology.quota) : topology.logical;
+    const Calibration& calibration = profile.calibration;
+    profile.spin_iterations = 0;
+    if (cpus >= 2 && calibration.spin_ns > 0 && calibration.handoff_ns > 0)
+    {
+        double rounds = calibration.handoff_ns / calibration.spin_ns;
+        profile.spin_iterations = static_cast<unsigned>(std::min(rounds, 50000.0));
+    }
+}
+
+TuningProfile auto_tune(const TuningOptions& options)
+{
+    TuningProfile profile;
+    profile.workload = options.workload;
+    profile.topology = probe_topology();
+
+    if (!options.profile_path.empty())
+    {
+        TuningProfile saved;
+        if (load_profile(options.profile_path, saved) && saved.workload == profile.workload
+            && saved.topology.logical == profile.topology.logical && saved.topology.cores == profile.topology.cores
+            && std::abs(saved.topology.quota - profile.topology.quota) < 1e-6)
+        {
+            return saved;
+        }
+    }
+
+    if (options.calibrate)
+    {
+        profile.calibration = calibrate();
+    }
+    choose_settings(profile);
+    if (!options.profile_path.empty())
+    {
+        save_profile(profile, options.profile_path);
+    }
+    return profile;
+}
+
+bool save_profile(const TuningProfile& profile, const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        return false;
+    }
+    out << std::setprecision(10)
+        << "# threading tuning profile, delete to re-probe\n"
+        << "workload=" << workload_name(profile.workload) << "\n"
+        << "logical=" << profile.topology.logical << "\n"
+        << "cores=" << profile.topology.cores << "\n"
+        << "quota=" << profile.topology.quota << "\n"
+        << "handoff_ns=" << profile.calibration.handoff_ns << "\n"
+        << "spin_ns=" << profile.calibration.spin_ns << "\n"
+        << "threads=" << profile.threads << "\n"
+        << "spin_iterations=" << profile.spin_iterations << "\n";
+    return static_cast<bool>(out);
+}
+
+bool load_profile(const std::string& path, TuningProfile& profile)
+{
+    std::ifstream in(path);
+    std::map<std::string, std::string> values;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t eq = line.find('=');
+        if (line.empty() || line[0] == '#' || eq == std::string::npos)
+        {
+            continue;
+        }
+        values[line.substr(0, eq)] = line.substr(eq + 1);
+    }
+
+    for (const char* key : {"workload", "logical", "cores", "quota", "handoff_ns", "spin_ns", "threads", "spin_iterations"})
+    {
+        if (values.find(key) == values.end())
+        {
+            return false;
+        }
+    }
+    if (values["workload"] != workload_name(Workload::Compute) && values["workload"] != workload_name(Workload::Mixed))
+    {
+        return false;
+    }
+
+    profile.workload = values["workload"] == workload_name(Workload::Compute) ? Workload::Compute : Workload::Mixed;
+    profile.topology.logical = static_cast<unsigned>(std::strtoul(values["logical"].c_str(), nullptr, 10));
+    profile.topology.cores = static_cast<unsigned>(std::strtoul(values["cores"].c_str(), nullptr, 10));
+    profile.topology.quota = std::atof(values["quota"].c_str());
+    profile.calibration.handoff_ns = std::atof(values["handoff_ns"].c_str());
+    profile.calibration.spin_ns = std::atof(values["spin_ns"].c_str());
+    profile.threads = std::max<size_t>(1, std::strtoul(values["threads"].c_str(), nullptr, 10));
+    profile.spin_iterations = static_cast<unsigned>(std::strtoul(values["spin_iterations"].c_str(), nullptr, 10));
+    return true;
+}
+
+std::ostream& operator<<(std::ostream& out, const TuningProfile& profile)
+{
+    out << "Tuning (" << workload_name(profile.workload) << "): " << profile.topology.logical << " CPUs, "
+        << profile.topology.cores << " cores, quota ";
+    if (profile.topology.quota > 0)
+    {
+        out << profile.topology.quota << " CPUs";
+    }
+    else
+    {
+        out << "none";
+    }
+    if (profile.calibration.handoff_ns > 0)
+    {
+        out << ", handoff " << std::fixed << std::setprecision(1) << profile.calibration.handoff_ns / 1000.0
+            << "us, spin round " << profile.calibration.spin_ns << "ns" << std::defaultfloat;
+    }
+    return out << " -> " << profile.threads << " workers, spin " << profile.spin_iterations << " rounds";
+}
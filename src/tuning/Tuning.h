@@ -0,0 +1,97 @@
+//
+// Created by frank on 18/10/2026.
+//
+
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#include "Pool.h"
+
+/**
+ * What the pool will mostly run. Compute tasks get one worker per physical
+ * core, SMT siblings share its execution units; mixed work that stalls on
+ * memory or short waits also uses the siblings.
+ */
+enum class Workload
+{
+    Compute,
+    Mixed
+};
+
+/**
+ * The CPUs this process can actually use
+ */
+struct CpuTopology
+{
+    unsigned logical = 0; // CPUs in the affinity mask
+    unsigned cores = 0;   // physical cores among them
+    double quota = 0;     // cgroup CPU limit in CPUs, 0 when unlimited
+};
+
+/**
+ * Read sched_getaffinity, the SMT sibling lists in sysfs and the cgroup v1
+ * (cpu.cfs_quota_us) or v2 (cpu.max) CPU limit, the tightest along the path
+ */
+CpuTopology probe_topology();
+
+/**
+ * Costs measured on this machine, zero when the probe did not run
+ */
+struct Calibration
+{
+    double handoff_ns = 0; // median enqueue to start on a sleeping worker
+    double spin_ns = 0;    // one cpu_relax() round
+};
+
+/**
+ * A short probe, a few tens of milliseconds: times cpu_relax() and pings a
+ * one-worker pool
+ */
+Calibration calibrate();
+
+struct TuningProfile
+{
+    Workload workload = Workload::Compute;
+    CpuTopology topology;
+    Calibration calibration;
+    size_t threads = 1;
+    unsigned spin_iterations = 0;
+
+    // PoolOptions defaults with the spin budget applied
+    PoolOptions pool_options() const;
+};
+
+struct TuningOptions
+{
+    Workload workload = Workload::Compute;
+    bool calibrate = true;
+    // Where to load and save the profile, empty to always probe and never save
+    std::string profile_path;
+
+    /**
+     * THREADING_TUNING_PROFILE sets the profile path; unset, empty or "off"
+     * probes every run and writes nothing. THREADING_CALIBRATE=0 skips the probe.
+     */
+    static TuningOptions from_environment();
+};
+
+/**
+ * Pick a worker count and spin budget for this machine. A saved profile whose
+ * workload and topology still match is reused as is, skipping the probe, so
+ * hand edits to it stick; otherwise the result is saved for next time.
+ */
+TuningProfile auto_tune(const TuningOptions& options);
+
+// Derive threads and spin_iterations from the topology and calibration
+void choose_settings(TuningProfile& profile);
+
+bool save_profile(const TuningProfile& profile, const std::string& path);
+bool load_profile(const std::string& path, TuningProfile& profile);
+
+std::ostream& operator<<(std::ostream& out, const TuningProfile& profile);
+
+#endif // TUNING_H